@@ -48,31 +48,40 @@ template <typename T> concept Integer = std::is_integral_v<T>;
 #ifndef QQ_CONCEPT_Containers
 #define QQ_CONCEPT_Containers
 
+// Any instance of a standard container template, whatever its comparator, hash or allocator, eg.
+// std::map<std::string, std::string, std::less<>> is a std::map too.
+template <typename T, template <typename...> class Tmpl>
+struct is_instance_of : std::false_type {};
+template <template <typename...> class Tmpl, typename... Args>
+struct is_instance_of<Tmpl<Args...>, Tmpl> : std::true_type {};
+template <typename T, template <typename...> class Tmpl>
+inline constexpr bool is_instance_of_v = is_instance_of<std::decay_t<T>, Tmpl>::value;
+
 template <typename Container>
 concept SequentialContainer
-    = std::is_same_v<std::decay_t<Container>, std::vector<typename Container::value_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::list<typename Container::value_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::forward_list<typename Container::value_type>>;
+    = is_instance_of_v<Container, std::vector> ||
+      is_instance_of_v<Container, std::list> ||
+      is_instance_of_v<Container, std::forward_list>;
 
 template <typename Container>
 concept OrderedAssociativeContainer
-    = std::is_same_v<std::decay_t<Container>, std::map<typename Container::key_type, typename Container::mapped_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::multimap<typename Container::key_type, typename Container::mapped_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::set<typename Container::value_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::multiset<typename Container::value_type>>;
+    = is_instance_of_v<Container, std::map> ||
+      is_instance_of_v<Container, std::multimap> ||
+      is_instance_of_v<Container, std::set> ||
+      is_instance_of_v<Container, std::multiset>;
 
 template <typename Container>
 concept UnorderedAssociativeContainer
-    = std::is_same_v<std::decay_t<Container>, std::unordered_map<typename Container::key_type, typename Container::mapped_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::unordered_multimap<typename Container::key_type, typename Container::mapped_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::unordered_set<typename Container::value_type>> ||
-      std::is_same_v<std::decay_t<Container>, std::unordered_multiset<typename Container::value_type>>;
+    = is_instance_of_v<Container, std::unordered_map> ||
+      is_instance_of_v<Container, std::unordered_multimap> ||
+      is_instance_of_v<Container, std::unordered_set> ||
+      is_instance_of_v<Container, std::unordered_multiset>;
 
 template <typename Container>
 concept AssociativeContainer = OrderedAssociativeContainer<Container> || UnorderedAssociativeContainer<Container>;
 
 template <typename Container>
-concept ForwardListContainer = std::is_same_v<std::decay_t<Container>, std::forward_list<typename Container::value_type>>;
+concept ForwardListContainer = is_instance_of_v<Container, std::forward_list>;
 
 // ==================== Type Traits (for key extraction) ====================
 
@@ -20,6 +20,7 @@
 #include <fstream>
 #include <filesystem>
 #include "cfgfile.hpp"
+#include "fileext.hpp"
 
 using namespace std;
 
@@ -43,15 +44,16 @@ bool cfgfile::reload()
         return true;    // a new file for writing that may not exist
     }
 
-    ifstream ifs(srcfile);
-    if ( !ifs ) {
-        errmsg = "Failed to open file: "s + srcfile;
+    // The lines are views into the mapped file, not copies
+    const mapped_lines lines(srcfile);
+    if ( !lines.ok() ) {
+        errmsg = lines.errmsg;
         return false;
     }
 
-    string line;
     string current_section{};
-    while (getline(ifs, line)) {
+    TStrMap* options{};     // of current_section, created by its first option
+    for (const string_view line : lines) {
         string_view linesv = rmcommsv(line);
         if (linesv.empty()) continue;
 
@@ -59,26 +61,31 @@ bool cfgfile::reload()
             // Section name including leading and trailing spaces means that one or more space characters can act as section name.
             // Characters after ']' are ignored.
             current_section = lrmarksv(linesv, '[', ']');
+            options = nullptr;
             if (current_section.empty()) {
-                errmsg = "Invalid section header: "s + line;
+                errmsg = "Invalid section header: "s + string(line);
                 return false;
             }
             continue;
         }
 
         if (current_section.empty()) {
-            errmsg = "Option outside of section: "s + line;
+            errmsg = "Option outside of section: "s + string(line);
             return false;
         }
 
         const auto& [key, value] {splitpairsv(linesv,separator)};
 
         if( key.empty() ) {
-            errmsg = "Empty key in option: "s + line;
+            errmsg = "Empty key in option: "s + string(line);
             return false;
         }
 
-        cfg[current_section][string(key)] = value;
+        if (!options) options = &cfg[current_section];
+        if (const auto it {options->find(key)}; it != options->end())
+            it->second = value;
+        else
+            options->emplace(key, value);
     }
 
     return true;
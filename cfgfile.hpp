@@ -30,7 +30,7 @@ protected:
     const char separator;
 public:
     std::string errmsg;
-    std::map<std::string, TStrMap> cfg;
+    std::map<std::string, TStrMap, std::less<>> cfg;    // transparent: cfg.find(sv) needs no std::string
 
     // After initializing an instance, check errmsg to judge if error occurs.
     cfgfile(const std::string sfile={}, cfgopenmode mode=cfgopenmode::r, const char sep='=')
@@ -145,5 +145,5 @@ public:
     ~TTimeout() = default;
 };
 
-using TimeoutManager = std::map<std::string, TTimeout>;
+using TimeoutManager = std::map<std::string, TTimeout, std::less<>>;
 //------------------------------------------------------------------------------------------------
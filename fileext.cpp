@@ -0,0 +1,113 @@
+//  File library extentions.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#include <cerrno>
+#include <utility>
+#include "fileext.hpp"
+
+#ifdef _WIN32
+  #include <fstream>
+  #include <iterator>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+using namespace std;
+
+//------------------------------------------------------------------------
+mapped_file::mapped_file(const string& path)
+{
+#ifdef _WIN32
+    ifstream ifs(path, ios::binary);
+    if (!ifs) {
+        errmsg = "Failed to open file: "s + path;
+        return;
+    }
+    buf_.assign(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+    data_ = buf_.data();
+    size_ = buf_.size();
+#else
+    const int fd {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0) {
+        errmsg = "Failed to open file: "s + path + ": " + strerror(errno);
+        return;
+    }
+
+    // A regular file with a size is mapped. /proc files report a size of 0, pipes and FIFOs
+    // cannot be mapped at all: those are read to the end instead.
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p {::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0)};
+        if (p != MAP_FAILED) {
+            ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            data_   = static_cast<const char*>(p);
+            size_   = static_cast<size_t>(st.st_size);
+            mapped_ = true;
+            ::close(fd);
+            return;
+        }
+    }
+
+    char chunk[64 * 1024];
+    while (true) {
+        const ssize_t n {::read(fd, chunk, sizeof(chunk))};
+        if (n > 0) { buf_.append(chunk, static_cast<size_t>(n)); continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) errmsg = "Failed to read file: "s + path + ": " + strerror(errno);
+        break;
+    }
+    ::close(fd);
+    data_ = buf_.data();
+    size_ = buf_.size();
+#endif
+}
+
+//------------------------------------------------------------------------
+void mapped_file::release() noexcept
+{
+#ifndef _WIN32
+    if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+    data_   = nullptr;
+    size_   = 0;
+    mapped_ = false;
+    buf_.clear();
+}
+
+//------------------------------------------------------------------------
+mapped_file::mapped_file(mapped_file&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this == &other) return *this;
+    release();
+    mapped_ = std::exchange(other.mapped_, false);
+    size_   = std::exchange(other.size_, 0);
+    buf_    = std::move(other.buf_);
+    data_   = mapped_? std::exchange(other.data_, nullptr) : buf_.data();
+    other.data_ = nullptr;
+    other.buf_.clear();
+    errmsg  = std::move(other.errmsg);
+    return *this;
+}
@@ -0,0 +1,109 @@
+//  File library extentions.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+//------------------------------------------------------------------------
+// Read-only contents of a whole file. A regular file is memory mapped with a sequential access
+// hint; anything mmap cannot take (a pipe, a FIFO, /proc files, Windows) is read() into a buffer.
+// After construction check errmsg (or ok()) like cfgfile.
+class mapped_file {
+private:
+    const char* data_{};
+    size_t size_{};
+    bool mapped_{};
+    std::string buf_;       // the contents when not mapped
+
+    void release() noexcept;
+
+public:
+    std::string errmsg;
+
+    mapped_file() = default;
+    explicit mapped_file(const std::string& path);
+    ~mapped_file() { release(); }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    [[nodiscard]] bool ok() const noexcept { return errmsg.empty(); }
+    bool mapped() const noexcept { return mapped_; }
+
+    const char* data() const noexcept { return data_; }
+    size_t      size() const noexcept { return size_; }
+    std::string_view contents() const noexcept { return {data_, size_}; }
+};
+
+//------------------------------------------------------------------------
+// The lines of a file as std::string_view, without copying, eg.
+//      mapped_lines lines("/var/log/app.log");
+//      if (!lines.ok()) { std::cerr << lines.errmsg; return; }
+//      for (std::string_view line : lines) { ... }
+// Lines are ended by "\n", which is not part of the views, and a '\r' ending a line is dropped too.
+// Like std::getline a last line with no new line is still a line, and a file ending with a new
+// line has no empty line after it. The new lines are found by memchr, vectorized by the C library.
+// The views point into the mapping and stay valid while the mapped_lines object lives.
+class mapped_lines : public mapped_file {
+public:
+    class iterator {
+    private:
+        const char* next_{};    // start of the line after line_
+        const char* end_{};
+        std::string_view line_;
+        bool done_{true};
+
+        void advance() noexcept {
+            if (next_ == end_) { done_ = true; return; }
+            const char* nl {static_cast<const char*>(std::memchr(next_, '\n', static_cast<size_t>(end_ - next_)))};
+            const char* stop {nl? nl : end_};
+            line_ = std::string_view(next_, static_cast<size_t>(stop - next_));
+            if (!line_.empty() && line_.back() == '\r') line_.remove_suffix(1);
+            next_ = nl? nl + 1 : end_;
+        }
+
+    public:
+        using iterator_concept  = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(const char* data, size_t size) noexcept: next_(data), end_(data + size), done_(false) { advance(); }
+
+        std::string_view operator*() const noexcept { return line_; }
+        iterator& operator++()    noexcept { advance(); return *this; }
+        iterator  operator++(int) noexcept { auto tmp{*this}; advance(); return tmp; }
+
+        friend bool operator==(const iterator& a, const iterator& b) noexcept
+            { return a.done_ == b.done_ && (a.done_ || a.next_ == b.next_); }
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept { return it.done_; }
+    };
+
+    explicit mapped_lines(const std::string& path): mapped_file(path) {}
+
+    iterator begin() const noexcept { return iterator(data(), size()); }
+    std::default_sentinel_t end() const noexcept { return std::default_sentinel; }
+};
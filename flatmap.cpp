@@ -0,0 +1,128 @@
+//  Read-only sorted string map packed into contiguous arrays.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include "flatmap.hpp"
+
+namespace {
+
+// First 8 bytes as a big-endian number, zero padded. Where two prefixes differ they order the
+// strings as std::string_view::compare does: a zero pad byte is below any real byte, and a key
+// padded at byte i is a proper prefix of the other.
+uint64_t prefix8(std::string_view sv) noexcept
+{
+    uint64_t w{};
+    const size_t n {std::min<size_t>(sv.size(), 8)};
+    for (size_t i = 0; i < n; ++i) w |= uint64_t{static_cast<unsigned char>(sv[i])} << (56 - 8*i);
+    return w;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------
+void flat_strmap::add(std::string_view key, std::string_view value)
+{
+    if (arena_.size() + key.size() + value.size() > UINT32_MAX) throw std::length_error("flat_strmap: more than 4GB of strings");
+    const auto koff {static_cast<uint32_t>(arena_.size())};
+    arena_.append(key);
+    const auto voff {static_cast<uint32_t>(arena_.size())};
+    arena_.append(value);
+    entries_.push_back({koff, static_cast<uint32_t>(key.size()), voff, static_cast<uint32_t>(value.size())});
+}
+
+//------------------------------------------------------------------------------------------------
+void flat_strmap::build()
+{
+    const auto less {[this](const entry& a, const entry& b) { return key_of(a) < key_of(b); }};
+
+    // A std::map arrives sorted and unique; anything else is sorted, deduplicated and repacked so
+    // the arena is in key order too.
+    if (std::adjacent_find(entries_.begin(), entries_.end(), [&](const entry& a, const entry& b) { return !less(a, b); }) != entries_.end()) {
+        std::stable_sort(entries_.begin(), entries_.end(), less);
+
+        std::vector<entry> uniq;
+        uniq.reserve(entries_.size());
+        for (size_t i = 0; i < entries_.size(); ++i)
+            if (i+1 == entries_.size() || less(entries_[i], entries_[i+1])) uniq.push_back(entries_[i]);   // last of equal keys
+
+        std::string arena;
+        arena.reserve(arena_.size());
+        for (entry& e : uniq) {
+            const auto koff {static_cast<uint32_t>(arena.size())};
+            arena.append(key_of(e));
+            const auto voff {static_cast<uint32_t>(arena.size())};
+            arena.append(val_of(e));
+            e.koff = koff;
+            e.voff = voff;
+        }
+        arena_.swap(arena);
+        entries_.swap(uniq);
+    }
+    arena_.shrink_to_fit();
+    entries_.shrink_to_fit();
+
+    // An in-order walk of the implicit tree (children of k are 2k and 2k+1) hands out the sorted
+    // entries in order.
+    const size_t n {entries_.size()};
+    eprefix_.assign(n + 1, 0);
+    eindex_.assign(n + 1, 0);
+    size_t next{};
+    const auto fill {[&](auto& self, size_t k) -> void {
+        if (k > n) return;
+        self(self, 2*k);
+        eprefix_[k] = prefix8(key_of(entries_[next]));
+        eindex_[k]  = static_cast<uint32_t>(next++);
+        self(self, 2*k + 1);
+    }};
+    fill(fill, 1);
+}
+
+//------------------------------------------------------------------------------------------------
+// Branch-free lower bound over the Eytzinger layout: descend right while the node is below key,
+// then the last left turn, found by dropping the trailing 1 bits and one 0 bit, is the answer.
+size_t flat_strmap::search(std::string_view key) const noexcept
+{
+    const size_t n {entries_.size()};
+    const uint64_t kp {prefix8(key)};
+    const uint64_t* pre {eprefix_.data()};
+
+    size_t k {1};
+    while (k <= n) {
+#if defined(__GNUC__)
+        __builtin_prefetch(pre + 8*k);     // the 8 great-grandchildren share one cache line
+#endif
+        const uint64_t p {pre[k]};
+        const bool below {p < kp || (p == kp && key_of(entries_[eindex_[k]]) < key)};
+        k = 2*k + below;
+    }
+    k >>= std::countr_one(k) + 1;
+
+    if (k == 0) return n;
+    const size_t i {eindex_[k]};
+    return key_of(entries_[i]) == key? i : n;
+}
+
+//------------------------------------------------------------------------------------------------
+std::string_view flat_strmap::at(std::string_view key) const
+{
+    const size_t i {search(key)};
+    if (i == size()) throw std::out_of_range("flat_strmap::at: no such key");
+    return val_of(entries_[i]);
+}
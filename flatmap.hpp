@@ -0,0 +1,132 @@
+//  Read-only sorted string map packed into contiguous arrays.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <compare>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "strext.hpp"
+
+// Eg. a config section that is read on every request:
+//     const flat_strmap opts(cfg.cfg["server"]);
+//     std::string_view port = opts.get("port", "8080");
+//     for (auto [key, value] : opts) ...     // in key order
+
+//------------------------------------------------------------------------------------------------
+// A std::string -> std::string map that is built once and then only looked up. All keys and values
+// live back to back in one character arena and entries are 32-bit offsets into it, so there is no
+// allocation per entry and no pointer chasing. Lookups search an Eytzinger (BFS) ordered copy of
+// the keys' first 8 bytes, which keeps the top levels of the search in a few cache lines; the arena
+// is read only for keys sharing those 8 bytes and for the final match.
+class flat_strmap {
+private:
+    struct entry {
+        uint32_t koff, klen;
+        uint32_t voff, vlen;
+    };
+
+    std::string arena_;
+    std::vector<entry>    entries_;     // sorted by key
+    std::vector<uint64_t> eprefix_;     // 1-based Eytzinger order: big-endian first 8 key bytes
+    std::vector<uint32_t> eindex_;      // 1-based Eytzinger order: index into entries_
+
+    std::string_view key_of(const entry& e) const noexcept { return {arena_.data()+e.koff, e.klen}; }
+    std::string_view val_of(const entry& e) const noexcept { return {arena_.data()+e.voff, e.vlen}; }
+
+    void add(std::string_view key, std::string_view value);
+    void build();
+    size_t search(std::string_view key) const noexcept;     // index into entries_, or size()
+
+public:
+    class const_iterator {
+    private:
+        const flat_strmap* map_{};
+        size_t i_{};
+
+    public:
+        using iterator_concept  = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;  // operator* returns a value
+        using value_type        = TSvPair;
+        using difference_type   = std::ptrdiff_t;
+
+        const_iterator() = default;
+        const_iterator(const flat_strmap* m, size_t i) noexcept: map_(m), i_(i) {}
+
+        TSvPair operator*() const noexcept { const entry& e {map_->entries_[i_]}; return {map_->key_of(e), map_->val_of(e)}; }
+        TSvPair operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        const_iterator& operator++()    noexcept { ++i_; return *this; }
+        const_iterator  operator++(int) noexcept { auto tmp{*this}; ++i_; return tmp; }
+        const_iterator& operator--()    noexcept { --i_; return *this; }
+        const_iterator  operator--(int) noexcept { auto tmp{*this}; --i_; return tmp; }
+        const_iterator& operator+=(difference_type n) noexcept { i_ += static_cast<size_t>(n); return *this; }
+        const_iterator& operator-=(difference_type n) noexcept { i_ -= static_cast<size_t>(n); return *this; }
+
+        friend const_iterator  operator+(const_iterator it, difference_type n) noexcept { return it += n; }
+        friend const_iterator  operator+(difference_type n, const_iterator it) noexcept { return it += n; }
+        friend const_iterator  operator-(const_iterator it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(const const_iterator& a, const const_iterator& b) noexcept
+            { return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_); }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept { return a.i_ == b.i_; }
+        friend auto operator<=>(const const_iterator& a, const const_iterator& b) noexcept { return a.i_ <=> b.i_; }
+    };
+    using iterator   = const_iterator;
+    using value_type = TSvPair;
+
+    flat_strmap() = default;
+
+    // Bulk build from any range of string pairs: TStrMap, TSvMap, std::vector<TSvPair>, ...
+    // The input need not be sorted; of equal keys the last one wins, like a repeated cfgfile option.
+    // Throws std::length_error when the keys and values exceed 4GB.
+    template <std::ranges::input_range R>
+    explicit flat_strmap(const R& pairs) {
+        if constexpr (std::ranges::sized_range<R>) entries_.reserve(std::ranges::size(pairs));
+        for (const auto& [key, value] : pairs) add(key, value);
+        build();
+    }
+    flat_strmap(std::initializer_list<TSvPair> il): flat_strmap(std::views::all(il)) {}
+
+    const_iterator find(std::string_view key) const noexcept { return {this, search(key)}; }
+    bool   contains(std::string_view key) const noexcept { return search(key) != size(); }
+    size_t count   (std::string_view key) const noexcept { return contains(key)? 1 : 0; }
+
+    // Value of key; at() throws std::out_of_range like std::map::at, get() returns dflt
+    std::string_view at (std::string_view key) const;
+    std::string_view get(std::string_view key, std::string_view dflt={}) const noexcept {
+        const size_t i {search(key)};
+        return i == size()? dflt : val_of(entries_[i]);
+    }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+    const_iterator end()   const noexcept { return {this, size()}; }
+
+    size_t size()  const noexcept { return entries_.size(); }
+    bool   empty() const noexcept { return entries_.empty(); }
+    // Heap bytes in use, for comparing with the node-based maps
+    size_t bytes() const noexcept {
+        return arena_.capacity() + entries_.capacity()*sizeof(entry)
+             + eprefix_.capacity()*sizeof(uint64_t) + eindex_.capacity()*sizeof(uint32_t);
+    }
+};
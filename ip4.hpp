@@ -55,11 +55,22 @@ public:
 
     [[nodiscard]] uint32_t get_aa() const noexcept { return aa; }
 
+    // Dotted form written to out without allocating, eg. for strjoin; returns the end of the text
+    static constexpr size_t max_chars = 15;
+    char* to_chars(char* out) const noexcept {
+        for (size_t i = 0; i < 4; ++i) {
+            if (i) *out++ = '.';
+            const unsigned b = (*this)[i];
+            if (b >= 100) *out++ = static_cast<char>('0' + b / 100);
+            if (b >= 10)  *out++ = static_cast<char>('0' + b / 10 % 10);
+            *out++ = static_cast<char>('0' + b % 10);
+        }
+        return out;
+    }
+
     [[nodiscard]] std::string sa() const {
-        return std::to_string((*this)[0]) + "." +
-               std::to_string((*this)[1]) + "." +
-               std::to_string((*this)[2]) + "." +
-               std::to_string((*this)[3]);
+        char buf[max_chars];
+        return std::string(buf, to_chars(buf));
     }
 
     auto operator<=>(const ip4& other) const noexcept { return aa <=> other.aa; }   // Since C++ 20
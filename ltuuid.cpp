@@ -23,22 +23,28 @@ namespace ltuuid {
 
 //------------------------------------------------------------------------
 // String conversion implementation
-std::string uuid::str() const
+char* uuid::to_chars(char* out) const noexcept
 {
     constexpr auto hex = "0123456789abcdef";
-    std::array<char, 36> buf{};
 
     auto fill = [&](auto val, size_t start, size_t len) {
         for (size_t i = 0; i < len; ++i)
-            buf[start + i] = hex[(val >> (4 * (len - 1 - i))) & 0xF];
+            out[start + i] = hex[(val >> (4 * (len - 1 - i))) & 0xF];
     };
 
-    fill(ab >> 32, 0, 8);            buf[8]  = '-';
-    fill((ab >> 16) & 0xFFFF, 9, 4); buf[13] = '-';
-    fill(ab & 0xFFFF, 14, 4);        buf[18] = '-';
-    fill(cd >> 48, 19, 4);           buf[23] = '-';
+    fill(ab >> 32, 0, 8);            out[8]  = '-';
+    fill((ab >> 16) & 0xFFFF, 9, 4); out[13] = '-';
+    fill(ab & 0xFFFF, 14, 4);        out[18] = '-';
+    fill(cd >> 48, 19, 4);           out[23] = '-';
     fill(cd & 0xFFFFFFFFFFFF, 24, 12);
 
+    return out + max_chars;
+}
+
+std::string uuid::str() const
+{
+    std::array<char, max_chars> buf;
+    to_chars(buf.data());
     return std::string(buf.data(), buf.size());
 }
 //------------------------------------------------------------------------
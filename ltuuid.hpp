@@ -55,6 +55,10 @@ struct uuid {
 
     std::string str() const;
 
+    // Canonical 8-4-4-4-12 form written to out without allocating, eg. for strjoin; returns the end
+    static constexpr size_t max_chars = 36;
+    char* to_chars(char* out) const noexcept;
+
 #ifdef __glibcxx_format
     template<typename FormatContext>
     auto format(FormatContext& ctx) const {
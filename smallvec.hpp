@@ -0,0 +1,213 @@
+//  A std::vector-like container keeping its first N elements inline.
+//
+//  Header-only file.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <iterator>
+#include <algorithm>
+#include <compare>  // Since C++ 20
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// small_vector<T,N> stores up to N elements in the object itself and moves them to the heap only
+// when the (N+1)th one is added. Iterators are plain pointers, so it is a contiguous range and works
+// with <algorithm>, std::ranges and range-for like std::vector. Eg.
+//     small_vector<std::string_view> toks;     // no heap allocation for up to 16 tokens
+//     splitsv(toks, line, ",");
+// As with std::vector, growing invalidates iterators; moving an inline small_vector moves its
+// elements one by one instead of stealing a pointer.
+template <typename T, size_t N=16>
+class small_vector {
+    static_assert(N > 0, "small_vector needs an inline capacity");
+
+public:
+    using value_type             = T;
+    using size_type              = size_t;
+    using difference_type        = std::ptrdiff_t;
+    using reference              = T&;
+    using const_reference        = const T&;
+    using pointer                = T*;
+    using const_pointer          = const T*;
+    using iterator               = T*;
+    using const_iterator         = const T*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_t inline_capacity = N;
+
+private:
+    T* data_;
+    size_t size_{};
+    size_t cap_{N};
+    alignas(T) std::byte buf_[N * sizeof(T)];
+
+          T* inline_data()       noexcept { return std::launder(reinterpret_cast<T*>(buf_)); }
+    const T* inline_data() const noexcept { return std::launder(reinterpret_cast<const T*>(buf_)); }
+
+    void release() noexcept {
+        std::destroy_n(data_, size_);
+        if (!is_inline()) std::allocator<T>{}.deallocate(data_, cap_);
+        data_ = inline_data();
+        size_ = 0;
+        cap_  = N;
+    }
+
+    void relocate(size_t ncap) {
+        T* p = std::allocator<T>{}.allocate(ncap);
+        if constexpr (std::is_nothrow_move_constructible_v<T>)
+            std::uninitialized_move_n(data_, size_, p);
+        else {
+            try { std::uninitialized_copy_n(data_, size_, p); }
+            catch (...) { std::allocator<T>{}.deallocate(p, ncap); throw; }
+        }
+        std::destroy_n(data_, size_);
+        if (!is_inline()) std::allocator<T>{}.deallocate(data_, cap_);
+        data_ = p;
+        cap_  = ncap;
+    }
+
+    void grow_for(size_t n) { if (n > cap_) relocate(std::max(n, cap_ * 2)); }
+
+    // Take other's elements, leaving it empty; *this must be empty
+    void steal(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (other.is_inline()) {
+            std::uninitialized_move_n(other.data_, other.size_, data_);
+            size_ = other.size_;
+            other.clear();
+        } else {
+            data_ = std::exchange(other.data_, other.inline_data());
+            size_ = std::exchange(other.size_, 0);
+            cap_  = std::exchange(other.cap_, N);
+        }
+    }
+
+public:
+    small_vector() noexcept: data_(inline_data()) {}
+    explicit small_vector(size_t n): small_vector() { resize(n); }
+    small_vector(size_t n, const T& value): small_vector() { resize(n, value); }
+    small_vector(std::initializer_list<T> il): small_vector(il.begin(), il.end()) {}
+
+    template <std::input_iterator It>
+    small_vector(It first, It last): small_vector() { assign(first, last); }
+
+    small_vector(const small_vector& other): small_vector(other.begin(), other.end()) {}
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>): small_vector() { steal(other); }
+
+    ~small_vector() { release(); }
+
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) { release(); steal(other); }
+        return *this;
+    }
+    small_vector& operator=(std::initializer_list<T> il) { assign(il.begin(), il.end()); return *this; }
+
+    template <std::input_iterator It>
+    void assign(It first, It last) {
+        clear();
+        if constexpr (std::forward_iterator<It>) reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) emplace_back(*first);
+    }
+
+    // Lets a small_vector be passed where a std::vector is expected
+    operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+          iterator begin()        noexcept { return data_; }
+    const_iterator begin()  const noexcept { return data_; }
+    const_iterator cbegin() const noexcept { return data_; }
+          iterator end()          noexcept { return data_ + size_; }
+    const_iterator end()    const noexcept { return data_ + size_; }
+    const_iterator cend()   const noexcept { return data_ + size_; }
+          reverse_iterator rbegin()       noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+          reverse_iterator rend()         noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()   const noexcept { return const_reverse_iterator(begin()); }
+
+          T* data()       noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    size_t size()      const noexcept { return size_; }
+    size_t capacity()  const noexcept { return cap_; }
+    bool   is_inline() const noexcept { return data_ == inline_data(); }
+
+          T& operator[](size_t i)       noexcept { return data_[i]; }
+    const T& operator[](size_t i) const noexcept { return data_[i]; }
+          T& front()       noexcept { return data_[0]; }
+    const T& front() const noexcept { return data_[0]; }
+          T& back()        noexcept { return data_[size_-1]; }
+    const T& back()  const noexcept { return data_[size_-1]; }
+
+    void reserve(size_t n) { if (n > cap_) relocate(n); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == cap_) {
+            // args may refer to an element, so construct it before the old storage goes away
+            T tmp(std::forward<Args>(args)...);
+            grow_for(size_ + 1);
+            return *std::construct_at(data_ + size_++, std::move(tmp));
+        }
+        return *std::construct_at(data_ + size_++, std::forward<Args>(args)...);
+    }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value)      { emplace_back(std::move(value)); }
+    void pop_back() noexcept       { std::destroy_at(data_ + --size_); }
+
+    void resize(size_t n) {
+        if (n < size_) { std::destroy(data_ + n, data_ + size_); size_ = n; return; }
+        grow_for(n);
+        for (; size_ < n; ++size_) std::construct_at(data_ + size_);
+    }
+    void resize(size_t n, const T& value) {
+        if (n < size_) { std::destroy(data_ + n, data_ + size_); size_ = n; return; }
+        if (n > cap_) { const T tmp(value); grow_for(n); for (; size_ < n; ++size_) std::construct_at(data_ + size_, tmp); return; }
+        for (; size_ < n; ++size_) std::construct_at(data_ + size_, value);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        T* f = data_ + (first - data_);
+        T* l = data_ + (last - data_);
+        if (f != l) {
+            T* e = std::move(l, end(), f);
+            std::destroy(e, end());
+            size_ = static_cast<size_t>(e - data_);
+        }
+        return f;
+    }
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    // Keeps the capacity, a cleared heap buffer is reused by the next fill
+    void clear() noexcept { std::destroy_n(data_, size_); size_ = 0; }
+
+    friend bool operator==(const small_vector& a, const small_vector& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+    friend auto operator<=>(const small_vector& a, const small_vector& b) {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+    }
+};
@@ -17,8 +17,14 @@
 //------------------------------------------------------------------------
 
 #include <random>
+#include <cerrno>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
+#include <span>
+#if defined(__linux__)
+  #include <sys/random.h>
+#endif
 #include "strext.hpp"
 
 using namespace std::string_literals;
@@ -92,56 +98,683 @@ std::string replall(std::string_view src, std::string_view sfind, std::string_vi
     return result;
 }
 //----------------------------------------------------------------------------------------
-std::string genPassword(PasswordSecurityLevel level, size_t length)
+replacer::replacer(std::string_view sfind, std::string_view swith): find_(sfind), with_(swith)
 {
-    const std::string lowercase    {"abcdefghijklmnopqrstuvwxyz"};
-    const std::string uppercase    {"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
-    const std::string digits       {"0123456789"};
-    const std::string specialChars {"!@#$%^&*()_+-=[]{}|;':\",./<>?"};
+    const size_t n {find_.size()};
+    std::fill(std::begin(skip_), std::end(skip_), n);
+    for (size_t i = 0; i+1 < n; ++i) skip_[static_cast<unsigned char>(find_[i])] = n-1-i;
+}
 
-    std::vector<std::string> required_charsets;
-    std::string full_charset;
+//----------------------------------------------------------------------------------------
+size_t replacer::find(std::string_view src, size_t pos) const noexcept
+{
+    const size_t n {find_.size()};
+    if (n == 0 || pos > src.size() || src.size() - pos < n) return std::string_view::npos;
+    if (n == 1) return src.find(find_[0], pos);
 
-    switch (level) {
-        case PasswordSecurityLevel::LOW:
-            required_charsets = {lowercase, digits};
-            full_charset = lowercase + digits;
+    const char* const data {src.data()};
+    const char* const needle {find_.data()};
+    const char last {needle[n-1]};
+    for (size_t i = pos; i + n <= src.size(); ) {
+        const char c {data[i+n-1]};
+        if (c == last && std::memcmp(data+i, needle, n-1) == 0) return i;
+        i += skip_[static_cast<unsigned char>(c)];
+    }
+    return std::string_view::npos;
+}
+
+//----------------------------------------------------------------------------------------
+size_t replacer::count(std::string_view src) const noexcept
+{
+    size_t num{};
+    for (size_t pos = find(src); !npossv(pos); pos = find(src, pos + find_.size())) ++num;
+    return num;
+}
+
+//----------------------------------------------------------------------------------------
+std::string replacer::replace(std::string_view src) const
+{
+    size_t pos {find(src)};
+    if (npossv(pos)) return std::string{src};
+
+    std::string result{};
+    result.reserve(with_.size() > find_.size()? src.size() + count(src) * (with_.size() - find_.size()) : src.size());
+
+    size_t last_pos{};
+    for (; !npossv(pos); pos = find(src, last_pos)) {
+        result.append(src.data() + last_pos, pos - last_pos);
+        result.append(with_);
+        last_pos = pos + find_.size();
+    }
+    result.append(src.data() + last_pos, src.size() - last_pos);
+    return result;
+}
+
+//----------------------------------------------------------------------------------------
+std::string& replacer::replacerf(std::string& src) const
+{
+    const size_t flen {find_.size()}, wlen {with_.size()};
+    size_t pos {find(src)};
+    if (npossv(pos)) return src;
+
+    if (flen == wlen) {
+        for (; !npossv(pos); pos = find(src, pos + flen)) src.replace(pos, flen, with_);
+        return src;
+    }
+
+    // Growing: move the text to the tail of the enlarged buffer, so that the write cursor below
+    // never overtakes the read cursor.
+    size_t rd {};
+    if (wlen > flen) {
+        const size_t old_len {src.size()};
+        const size_t grow {count(src) * (wlen - flen)};
+        src.resize(old_len + grow);
+        std::memmove(src.data() + grow, src.data(), old_len);
+        rd = grow;
+        pos += grow;
+    }
+
+    // Forward compaction: src[rd..] is unread input, src[..wr) is the result
+    char* const data {src.data()};
+    const std::string_view input {data, src.size()};
+    size_t wr {};
+    for (; !npossv(pos); pos = find(input, rd)) {
+        std::memmove(data + wr, data + rd, pos - rd);
+        wr += pos - rd;
+        std::memcpy(data + wr, with_.data(), wlen);
+        wr += wlen;
+        rd = pos + flen;
+    }
+    std::memmove(data + wr, data + rd, src.size() - rd);
+    src.resize(wr + src.size() - rd);
+    return src;
+}
+
+//----------------------------------------------------------------------------------------
+multi_replacer::multi_replacer(const std::vector<TSvPair>& rules)
+{
+    constexpr uint32_t none {UINT32_MAX};
+    const auto uc = [](char c) { return static_cast<unsigned char>(c); };
+
+    // Every byte used in a needle gets its own class, all other bytes share class 0
+    for (const auto& rl : rules)
+        for (const char c : rl.first)
+            if (!cls_[uc(c)]) cls_[uc(c)] = static_cast<uint16_t>(nclass_++);
+
+    // 第一阶段：构建 trie
+    delta_.assign(nclass_, none);
+    depth_.assign(1, 0);
+    out_.assign(1, 0);
+    for (const auto& [sfind, swith] : rules) {
+        if (sfind.empty()) continue;
+
+        uint32_t state{};
+        for (const char c : sfind) {
+            const size_t idx {state * nclass_ + cls_[uc(c)]};
+            if (delta_[idx] == none) {
+                delta_[idx] = static_cast<uint32_t>(depth_.size());
+                depth_.push_back(depth_[state] + 1);
+                out_.push_back(0);
+                delta_.resize(delta_.size() + nclass_, none);
+            }
+            state = delta_[idx];
+        }
+        if (out_[state]) continue;   // duplicated needle: the first rule wins
+
+        rules_.push_back({static_cast<uint32_t>(sfind.size()), static_cast<uint32_t>(with_.size()), static_cast<uint32_t>(swith.size())});
+        with_.append(swith);
+        out_[state] = static_cast<uint32_t>(rules_.size());
+        first_.set(sfind[0]);
+        min_find_ = min_find_? std::min(min_find_, sfind.size()) : sfind.size();
+        if (swith.size() > sfind.size()) max_growth_ = std::max(max_growth_, swith.size() - sfind.size());
+    }
+
+    // 第二阶段：按广度优先计算失配链接，并把缺失的转移补全为 DFA
+    std::vector<uint32_t> fail(depth_.size()), queue;
+    queue.reserve(depth_.size());
+    for (size_t c = 0; c < nclass_; ++c) {
+        uint32_t& next = delta_[c];
+        if (next == none) next = 0;
+        else queue.push_back(next);
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const uint32_t state {queue[head]};
+        if (!out_[state]) out_[state] = out_[fail[state]];     // longest needle that is a suffix
+        for (size_t c = 0; c < nclass_; ++c) {
+            uint32_t& next = delta_[state * nclass_ + c];
+            const uint32_t fnext {delta_[fail[state] * nclass_ + c]};
+            if (next == none) next = fnext;
+            else { fail[next] = fnext; queue.push_back(next); }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+// Calls on_match(pos, rule) for each replacement of src in order
+template <typename F>
+void multi_replacer::scan(std::string_view src, F&& on_match) const
+{
+    const size_t src_len {src.size()};
+    size_t i{};
+    uint32_t state{};
+    size_t best_pos {std::string_view::npos}, best_len{};
+    uint32_t best_rule{};
+
+    // One cursor over the needle first bytes for the whole pass, so each 64-byte block is
+    // classified once; cand is the next candidate it handed out
+    strscan::cursor firsts(src, first_);
+    size_t cand {firsts.next()};
+
+    while (true) {
+        // A pending match is final once the live partial match starts after it, or at the end
+        if (!npossv(best_pos) && (i == src_len || best_pos < i - depth_[state])) {
+            on_match(best_pos, rules_[best_rule]);
+            i = best_pos + best_len;
+            best_pos = std::string_view::npos;
+            state = 0;
+            continue;
+        }
+        if (i == src_len) break;
+
+        if (state == 0) {   // nothing in progress: jump to the next byte that can start a needle
+            if (!npossv(cand) && cand < i) {
+                // A match or partial match went past cand: reclassify only if i left its block
+                if (i / strscan::block != cand / strscan::block) firsts.seek(i);
+                do cand = firsts.next(); while (!npossv(cand) && cand < i);
+            }
+            if (npossv(cand)) break;
+            i = cand;
+        }
+
+        state = delta_[state * nclass_ + cls_[static_cast<unsigned char>(src[i++])]];
+        if (const uint32_t r {out_[state]}) {
+            const size_t len {rules_[r-1].find_len};
+            const size_t pos {i - len};
+            if (npossv(best_pos) || pos < best_pos || (pos == best_pos && len > best_len)) {
+                best_pos = pos;
+                best_len = len;
+                best_rule = r-1;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+size_t multi_replacer::count(std::string_view src) const noexcept
+{
+    size_t found{};
+    if (!rules_.empty()) scan(src, [&](size_t, const rule&) { ++found; });
+    return found;
+}
+
+//----------------------------------------------------------------------------------------
+std::string multi_replacer::replace(std::string_view src) const
+{
+    if (rules_.empty() || src.empty()) return std::string{src};
+
+    // One allocation. Shrinking rules never exceed src, and growing ones by at most max_growth_
+    // per min_find_ bytes; when that bound is above twice the input, a first pass sizes the
+    // result exactly instead, like replacer::replace does with count().
+    size_t size {src.size() + src.size() / min_find_ * max_growth_};
+    if (max_growth_ > min_find_) {
+        size = src.size();
+        scan(src, [&](size_t, const rule& rl) { size = size - rl.find_len + rl.with_len; });
+    }
+    std::string result{};
+    result.reserve(size);
+
+    size_t last{};                      // src[last..] has not been copied yet
+    scan(src, [&](size_t pos, const rule& rl) {
+        result.append(src.data() + last, pos - last);
+        result.append(with_.data() + rl.with_pos, rl.with_len);
+        last = pos + rl.find_len;
+    });
+    result.append(src.data() + last, src.size() - last);
+    return result;
+}
+
+//----------------------------------------------------------------------------------------
+// Rough frequency rank of a byte in log and text lines, lower is rarer. memchr stops less often
+// on a rare byte, so it is the one a mark is anchored on.
+static int byte_rank(unsigned char c) noexcept
+{
+    if (c == ' ') return 9;
+    if (c >= 'a' && c <= 'z') return std::string_view("etaoinsrhldcumfpgwybvkxjqz").find(static_cast<char>(c)) < 13 ? 8 : 6;
+    if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return 5;
+    if (c == '.' || c == ',' || c == '-' || c == '/' || c == ':' || c == '_' || c == '=' || c == '"') return 4;
+    if (c >= 0x80) return 3;
+    return c < 0x20 ? 1 : 2;    // other punctuation, control bytes
+}
+
+multiwin_extractor::mark multiwin_extractor::add_mark(std::string_view sv)
+{
+    mark m {static_cast<uint32_t>(marks_.size()), static_cast<uint32_t>(sv.size()), 0};
+    for (uint32_t i = 1; i < m.len; ++i)
+        if (byte_rank(sv[i]) < byte_rank(sv[m.anchor])) m.anchor = i;
+    marks_.append(sv);
+    return m;
+}
+
+multiwin_extractor::multiwin_extractor(const std::vector<TSvPair>& lrmarks)
+{
+    left_.reserve(lrmarks.size());
+    right_.reserve(lrmarks.size());
+    for (const auto& [l, r] : lrmarks) {
+        left_.push_back(add_mark(l));
+        right_.push_back(add_mark(r));
+    }
+}
+
+//----------------------------------------------------------------------------------------
+// Same result as src.find(mark, pos)
+size_t multiwin_extractor::find(std::string_view src, const mark& m, size_t pos) const noexcept
+{
+    if (pos > src.size() || src.size() - pos < m.len) return std::string_view::npos;
+    if (m.len == 0) return pos;
+
+    const char* needle {marks_.data() + m.pos};
+    const char* base {src.data()};
+    const char* p {base + pos + m.anchor};
+    const char* last {base + src.size() - m.len + m.anchor};    // the last place the anchor can be
+
+    while (p <= last) {
+        p = static_cast<const char*>(std::memchr(p, needle[m.anchor], static_cast<size_t>(last - p) + 1));
+        if (!p) break;
+        if (std::memcmp(p - m.anchor, needle, m.len) == 0) return static_cast<size_t>(p - m.anchor - base);
+        ++p;
+    }
+    return std::string_view::npos;
+}
+
+//----------------------------------------------------------------------------------------
+size_t multiwin_extractor::extract(std::string_view src, std::string_view* out, size_t begin_pos) const noexcept
+{
+    size_t found{};
+    size_t pos {begin_pos};
+    for (size_t i = 0; i < left_.size(); ++i) {
+        out[i] = {};
+        const size_t lpos {find(src, left_[i], pos)};
+        if (npossv(lpos)) continue;
+        const size_t start {lpos + left_[i].len};
+        const size_t rpos {find(src, right_[i], start)};
+        if (npossv(rpos)) continue;
+        out[i] = src.substr(start, rpos - start);
+        pos = rpos + right_[i].len;
+        ++found;
+    }
+    return found;
+}
+
+//----------------------------------------------------------------------------------------
+void csv_reader::reset(std::string_view src, bool final) noexcept
+{
+    src_      = src;
+    final_    = final;
+    pos_      = 0;
+    row_end_  = 0;
+    block_    = 0;
+    mask_     = 0;
+    in_quote_ = 0;
+    if (!src_.empty()) load();
+}
+
+//----------------------------------------------------------------------------------------
+// Classify the block at block_: separators and new lines that are not inside quotes
+void csv_reader::load() noexcept
+{
+    const size_t rest {src_.size() - block_};
+    const char* p {src_.data() + block_};
+    uint64_t valid {~uint64_t{0}};
+    char buf[strscan::block]{};
+    if (rest < strscan::block) {    // never read past the end
+        std::memcpy(buf, p, rest);
+        p = buf;
+        valid = (uint64_t{1} << rest) - 1;
+    }
+
+    const strscan::eq3_masks m {strscan::eq3_mask64(p, d_.quote, d_.sep, '\n')};
+    const uint64_t quotes {d_.quote? m.a & valid : 0};
+    const uint64_t inside {strscan::prefix_xor(quotes) ^ in_quote_};
+    in_quote_ = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+    mask_ = (m.b | m.c) & ~inside & valid;
+}
+
+//----------------------------------------------------------------------------------------
+size_t csv_reader::next_structural() noexcept
+{
+    while (!mask_) {
+        if (block_ + strscan::block >= src_.size()) return std::string_view::npos;
+        block_ += strscan::block;
+        load();
+    }
+    const size_t pos {block_ + static_cast<size_t>(std::countr_zero(mask_))};
+    mask_ &= mask_ - 1;
+    return pos;
+}
+
+//----------------------------------------------------------------------------------------
+// Find the field ends of the record at pos_; the last one is its '\n', or the end of src_
+bool csv_reader::next_record()
+{
+    if (pos_ >= src_.size()) return false;
+
+    ends_.clear();
+    while (true) {
+        const size_t end {next_structural()};
+        if (npossv(end)) {
+            if (!final_) return false;
+            ends_.push_back(src_.size());
             break;
-        case PasswordSecurityLevel::MEDIUM:
-            required_charsets = {lowercase, uppercase, digits};
-            full_charset = lowercase + uppercase + digits;
+        }
+        ends_.push_back(end);
+        if (src_[end] == '\n') break;
+    }
+
+    const size_t last_begin {ends_.size() > 1? ends_[ends_.size()-2] + 1 : pos_};
+    row_end_ = ends_.back();
+    if (row_end_ < src_.size() && row_end_ > last_begin && src_[row_end_-1] == '\r') --row_end_;
+
+    // Unescaped fields are never longer than the record, so the arena does not move while
+    // the views of this record are alive
+    arena_.clear();
+    arena_.reserve(row_end_ - pos_);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+std::string_view csv_reader::field(size_t begin, size_t end)
+{
+    const std::string_view raw {src_.substr(begin, end - begin)};
+    const char q {d_.quote};
+    if (!q || raw.empty() || !std::memchr(raw.data(), q, raw.size())) return raw;
+
+    // The usual quoted field: "...", with no quote inside
+    if (raw.size() >= 2 && raw.front() == q && raw.back() == q && !std::memchr(raw.data()+1, q, raw.size()-2))
+        return raw.substr(1, raw.size()-2);
+
+    const size_t start {arena_.size()};
+    bool quoted{};
+    for (size_t i = 0; i < raw.size(); ) {
+        const void* found {std::memchr(raw.data()+i, q, raw.size()-i)};
+        const size_t qpos {found? static_cast<size_t>(static_cast<const char*>(found) - raw.data()) : raw.size()};
+        arena_.append(raw.data()+i, qpos-i);
+        if (qpos == raw.size()) break;
+
+        if (quoted && qpos+1 < raw.size() && raw[qpos+1] == q) {   // "" inside quotes
+            arena_.push_back(q);
+            i = qpos + 2;
+        } else {
+            quoted = !quoted;
+            i = qpos + 1;
+        }
+    }
+    return {arena_.data() + start, arena_.size() - start};
+}
+
+//----------------------------------------------------------------------------------------
+static constexpr auto hex_value = [] {
+    std::array<int8_t, 256> tbl{};
+    tbl.fill(-1);
+    for (int i = 0; i < 10; ++i) tbl['0' + i] = static_cast<int8_t>(i);
+    for (int i = 0; i < 6; ++i)  tbl['a' + i] = tbl['A' + i] = static_cast<int8_t>(10 + i);
+    return tbl;
+}();
+
+std::string& percent_decode(std::string& dst, std::string_view src, bool plus_space)
+{
+    static const strscan::charset escapes {"%+"};
+    static const strscan::charset percent {'%'};
+
+    dst.reserve(dst.size() + src.size());
+    strscan::cursor cur(src, plus_space? escapes : percent);
+    size_t last{};      // src[last..] is not copied yet
+    for (size_t pos = cur.next(); !npossv(pos); pos = cur.next()) {
+        if (pos < last) continue;   // inside an escape already decoded
+        dst.append(src.data() + last, pos - last);
+        last = pos + 1;
+        if (src[pos] == '+') { dst.push_back(' '); continue; }
+
+        const int hi {pos + 2 < src.size()? hex_value[static_cast<unsigned char>(src[pos+1])] : -1};
+        const int lo {hi >= 0? hex_value[static_cast<unsigned char>(src[pos+2])] : -1};
+        if (lo < 0) { dst.push_back('%'); continue; }
+        dst.push_back(static_cast<char>(hi << 4 | lo));
+        last = pos + 3;
+    }
+    dst.append(src.data() + last, src.size() - last);
+    return dst;
+}
+
+//----------------------------------------------------------------------------------------
+kvlist::kvlist(std::string_view pair_seps, char kv_sep, bool plus_space)
+    : scan_(pair_seps), pair_seps_(pair_seps), kv_sep_(kv_sep), plus_space_(plus_space)
+{
+    scan_.set(kv_sep).set('%');
+    if (plus_space) scan_.set('+');
+}
+
+size_t kvlist::parse(std::string_view src)
+{
+    entries_.clear();
+    decoded_.clear();
+
+    size_t begin{};             // of the current pair
+    size_t kv {std::string_view::npos};     // its kv_sep
+    bool key_esc{}, value_esc{};
+    const auto close = [&](size_t end) {
+        if (end == begin) return;   // empty pair
+        if (npossv(kv))
+            entries_.push_back({src.substr(begin, end - begin), {}, key_esc, false});
+        else
+            entries_.push_back({src.substr(begin, kv - begin), src.substr(kv + 1, end - kv - 1), key_esc, value_esc});
+    };
+
+    strscan::cursor cur(src, scan_);
+    for (size_t pos = cur.next(); !npossv(pos); pos = cur.next()) {
+        const char c {src[pos]};
+        if (pair_seps_.test(c)) {
+            close(pos);
+            begin = pos + 1;
+            kv = std::string_view::npos;
+            key_esc = value_esc = false;
+        } else if (c == kv_sep_ && npossv(kv)) {
+            kv = pos;
+        } else if (c == '%' || c == '+') {
+            (npossv(kv)? key_esc : value_esc) = true;
+        }
+    }
+    close(src.size());
+    return entries_.size();
+}
+
+//----------------------------------------------------------------------------------------
+std::string_view kvlist::decode(std::string_view raw, bool escaped, uint32_t& idx) const
+{
+    if (!escaped) return raw;
+    if (idx == none) {
+        idx = static_cast<uint32_t>(decoded_.size());
+        percent_decode(decoded_.emplace_back(), raw, plus_space_);
+    }
+    return decoded_[idx];
+}
+
+std::optional<std::string_view> kvlist::find(std::string_view k) const
+{
+    for (size_t i = 0; i < entries_.size(); ++i)
+        if (key(i) == k) return value(i);
+    return std::nullopt;
+}
+
+//----------------------------------------------------------------------------------------
+static constexpr std::string_view PW_LOWER   {"abcdefghijklmnopqrstuvwxyz"};
+static constexpr std::string_view PW_UPPER   {"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+static constexpr std::string_view PW_DIGITS  {"0123456789"};
+static constexpr std::string_view PW_SPECIAL {"!@#$%^&*()_+-=[]{}|;':\",./<>?"};
+
+// Random bytes from the OS CSPRNG, fetched in bulk and handed out one by one
+class csprng_bytes {
+private:
+    unsigned char buf_[4096];
+    size_t len_;    // bytes used of buf_, fewer for a single short password
+    size_t pos_;
+
+    void refill() {
+#if defined(__linux__)
+        for (size_t got = 0; got < len_; ) {
+            const ssize_t n {::getrandom(buf_ + got, len_ - got, 0)};
+            if (n > 0) { got += static_cast<size_t>(n); continue; }
+            if (n < 0 && errno == EINTR) continue;
+            fill_from_random_device(got);      // no getrandom (ENOSYS), use the fallback
             break;
-        case PasswordSecurityLevel::HIGH:
-        default:
-            required_charsets = {lowercase, uppercase, digits, specialChars};
-            full_charset = lowercase + uppercase + digits + specialChars;
+        }
+#else
+        fill_from_random_device(0);
+#endif
+        pos_ = 0;
+    }
+
+    void fill_from_random_device(size_t from) {
+        static thread_local std::random_device rd;
+        for (size_t i = from; i < len_; i += sizeof(unsigned)) {
+            const unsigned r {rd()};
+            std::memcpy(buf_ + i, &r, std::min(sizeof(unsigned), len_ - i));
+        }
     }
 
-    const size_t min_length {required_charsets.size()};
-    length = std::max(min_length, length);
+public:
+    explicit csprng_bytes(size_t expected): len_(std::clamp<size_t>(expected, 64, sizeof(buf_))), pos_(len_) {}
 
-    static thread_local std::mt19937 gen(std::random_device{}());
+    unsigned char byte() { if (pos_ == len_) refill(); return buf_[pos_++]; }
 
-    std::string password;
-    for (const auto& charset : required_charsets) {
-        std::uniform_int_distribution<size_t> dis(0, charset.size() - 1);
-        password += charset[dis(gen)];
+    // Uniform in [0, m) by rejection sampling, so there is no modulo bias. One byte per draw when
+    // m <= 256, mapped by multiply and shift (Lemire): the 256 products b*m fall into m buckets of
+    // their high byte, and rejecting a low byte below 256 % m evens the buckets out. The division
+    // is needed only for a low byte below m, which is rare.
+    size_t below(size_t m) {
+        if (m <= 256) {
+            const auto m8 {static_cast<unsigned>(m)};
+            unsigned x {byte() * m8};
+            if ((x & 0xFF) < m8) {
+                const unsigned t {(256 - m8) % m8};
+                while ((x & 0xFF) < t) x = byte() * m8;
+            }
+            return x >> 8;
+        }
+        const uint64_t limit {UINT64_MAX - UINT64_MAX % m};
+        while (true) {
+            uint64_t r{};
+            for (size_t i = 0; i < sizeof(r); ++i) r = (r << 8) | byte();
+            if (r < limit) return static_cast<size_t>(r % m);
+        }
     }
+};
 
-    if (length > min_length) {
-        std::uniform_int_distribution<size_t> dis(0, full_charset.size() - 1);
-        for (size_t i = min_length; i < length; ++i)
-            password += full_charset[dis(gen)];
+std::string& genPasswords(std::string& dst, size_t n, PasswordSecurityLevel level, size_t length)
+{
+    static constexpr std::string_view full_low  {"abcdefghijklmnopqrstuvwxyz0123456789"};
+    static constexpr std::string_view full_med  {"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"};
+    static constexpr std::string_view full_high {"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!@#$%^&*()_+-=[]{}|;':\",./<>?"};
+    static constexpr std::string_view req_low[]  {PW_LOWER, PW_DIGITS};
+    static constexpr std::string_view req_med[]  {PW_LOWER, PW_UPPER, PW_DIGITS};
+    static constexpr std::string_view req_high[] {PW_LOWER, PW_UPPER, PW_DIGITS, PW_SPECIAL};
+
+    std::span<const std::string_view> required;
+    std::string_view full_charset;
+    switch (level) {
+        case PasswordSecurityLevel::LOW:    required = req_low;  full_charset = full_low;  break;
+        case PasswordSecurityLevel::MEDIUM: required = req_med;  full_charset = full_med;  break;
+        case PasswordSecurityLevel::HIGH:
+        default:                            required = req_high; full_charset = full_high;
+    }
+
+    const size_t k {required.size()};
+    length = std::max(k, length);
+    if (n > dst.max_size() / length) throw std::length_error("genPasswords: too many characters");
+    dst.resize(n * length);
+
+    // A draw from 62 or 91 chars is rejected now and then, so ask for a little more than 2 bytes
+    // per required char and 1 per other char
+    csprng_bytes rnd(n * (length + 2*k) + n * length / 8);
+    for (char* pw = dst.data(), *end = pw + dst.size(); pw != end; pw += length) {
+        for (size_t i = 0; i < length; ++i) pw[i] = full_charset[rnd.below(full_charset.size())];
+
+        // One char of each required set goes to a distinct random position. The other positions
+        // stay independent draws from the full set, which is what shuffling genPassword's
+        // required-chars-first string gives.
+        size_t pos[std::size(req_high)];
+        for (size_t r = 0; r < k; ++r) {
+            size_t p;
+            do p = rnd.below(length); while (std::find(pos, pos + r, p) != pos + r);
+            pos[r] = p;
+            pw[p] = required[r][rnd.below(required[r].size())];
+        }
     }
+    return dst;
+}
 
-    std::shuffle(password.begin(), password.end(), gen);
+std::string genPasswords(size_t n, PasswordSecurityLevel level, size_t length)
+{
+    std::string dst;
+    genPasswords(dst, n, level, length);
+    return dst;
+}
 
-    return password;
+//----------------------------------------------------------------------------------------
+std::string genPassword(PasswordSecurityLevel level, size_t length)
+{
+    return genPasswords(1, level, length);
 }
+
+// mt19937 version
+// std::string genPassword(PasswordSecurityLevel level, size_t length)
+// {
+//     const std::string lowercase    {"abcdefghijklmnopqrstuvwxyz"};
+//     const std::string uppercase    {"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+//     const std::string digits       {"0123456789"};
+//     const std::string specialChars {"!@#$%^&*()_+-=[]{}|;':\",./<>?"};
+//
+//     std::vector<std::string> required_charsets;
+//     std::string full_charset;
+//
+//     switch (level) {
+//         case PasswordSecurityLevel::LOW:
+//             required_charsets = {lowercase, digits};
+//             full_charset = lowercase + digits;
+//             break;
+//         case PasswordSecurityLevel::MEDIUM:
+//             required_charsets = {lowercase, uppercase, digits};
+//             full_charset = lowercase + uppercase + digits;
+//             break;
+//         case PasswordSecurityLevel::HIGH:
+//         default:
+//             required_charsets = {lowercase, uppercase, digits, specialChars};
+//             full_charset = lowercase + uppercase + digits + specialChars;
+//     }
+//
+//     const size_t min_length {required_charsets.size()};
+//     length = std::max(min_length, length);
+//
+//     static thread_local std::mt19937 gen(std::random_device{}());
+//
+//     std::string password;
+//     for (const auto& charset : required_charsets) {
+//         std::uniform_int_distribution<size_t> dis(0, charset.size() - 1);
+//         password += charset[dis(gen)];
+//     }
+//
+//     if (length > min_length) {
+//         std::uniform_int_distribution<size_t> dis(0, full_charset.size() - 1);
+//         for (size_t i = min_length; i < length; ++i)
+//             password += full_charset[dis(gen)];
+//     }
+//
+//     std::shuffle(password.begin(), password.end(), gen);
+//
+//     return password;
+// }
 //----------------------------------------------------------------------------------------
 bool chkPassword(std::string_view password, PasswordSecurityLevel level, size_t min_length)
 {
-    constexpr std::string_view specialChars {"!@#$%^&*()_+-=[]{}|;':\",./<>?"};
+    constexpr std::string_view specialChars {PW_SPECIAL};
 
     enum CharFlags : uint8_t {
         LOWER = 1 << 0,
@@ -154,7 +787,7 @@ bool chkPassword(std::string_view password, PasswordSecurityLevel level, size_t
 
     uint8_t flags{};
 
-    const auto check_complete = [level, flags] {
+    const auto check_complete = [level, &flags] {
         switch (level) {
             case PasswordSecurityLevel::LOW:
                 return (flags & LOWER) && (flags & DIGIT);
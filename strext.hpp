@@ -28,16 +28,23 @@
 #include <charconv>
 #include <optional>
 #include <bitset>
+#include <bit>
+#include <cstring>
+#include <limits>
 #include <set>
 #include <unordered_set>
 #include <stdexcept>
 #include <map>
+#include <deque>
 #include <memory>
 #include <ranges>
+#include <thread>
 #include <version>  // __cpp_lib_* macro
 
 #include "strjoin.hpp"
 #include "utf8_sv.hpp"
+#include "strscan.hpp"
+#include "smallvec.hpp"
 
 // About suffix of func names:
 //    s  - return std::string type
@@ -51,19 +58,26 @@
 
 using TStrVec = std::vector<std::string>;
 using TSvVec  = std::vector<std::string_view>;
+using TSvSVec = small_vector<std::string_view>;    // no heap allocation for up to 16 tokens
 
-using TStrSet  = std::set<std::string>;
-using TStrMSet = std::multiset<std::string>;
+// The std::string keyed containers compare and hash transparently: find(), count(), contains()
+// and equal_range() take the std::string_view tokens of splitsv as they are, without building a
+// temporary std::string per lookup. Eg.
+//     TStrSet keywords{"GET", "PUT"};
+//     for (std::string_view tok : split_view(line, " ")) if (keywords.contains(tok)) ...
+struct str_hash;
+using TStrSet  = std::set<std::string, std::less<>>;
+using TStrMSet = std::multiset<std::string, std::less<>>;
 
-using TStrUoSet  = std::unordered_set<std::string>;
-using TStrUoMSet = std::unordered_multiset<std::string>;
+using TStrUoSet  = std::unordered_set<std::string, str_hash, std::equal_to<>>;
+using TStrUoMSet = std::unordered_multiset<std::string, str_hash, std::equal_to<>>;
 
 using TStrPair = std::pair<std::string, std::string>;
 using TSvPair  = std::pair<std::string_view, std::string_view>;
 
-using TStrMap  = std::map<std::string, std::string>;
+using TStrMap  = std::map<std::string, std::string, std::less<>>;
 using TSvMap   = std::map<std::string_view, std::string_view>;
-using TStrMMap = std::multimap<std::string, std::string>;
+using TStrMMap = std::multimap<std::string, std::string, std::less<>>;
 
 extern const std::string EMPTY_STR;
 extern const std::string SPACE_CHARS;
@@ -81,6 +95,23 @@ extern const std::string SPACE_CHARS;
 template <typename T> concept Integer = std::is_integral_v<T>;
 #endif
 
+// Compile-time delimiter set, eg. splitsv<delims<" \t,">>(src). The 256-bit membership table is
+// built by the compiler, and the scanning kernel is picked by if constexpr from its size.
+template <size_t N> struct fixed_chars {
+    char chars[N]{};
+    constexpr fixed_chars(const char (&str)[N]) noexcept { std::copy_n(str, N, chars); }
+    constexpr std::string_view sv() const noexcept { return {chars, N-1}; }
+};
+template <fixed_chars S> struct delims {
+    static constexpr strscan::charset set{S.sv()};
+    constexpr operator const strscan::charset&() const noexcept { return set; }
+};
+template <typename T>    inline constexpr bool is_delims_v             = false;
+template <fixed_chars S> inline constexpr bool is_delims_v<delims<S>> = true;
+
+template <typename T>    struct delims_traits            { using cursor_type = strscan::cursor; };
+template <fixed_chars S> struct delims_traits<delims<S>> { using cursor_type = strscan::fixed_cursor<delims<S>::set>; };
+
 //------------------------------------------------------------------------------------------------
 inline std::string_view  leftsv(std::string_view sv,     size_t n) noexcept { return sv.substr(0,n); }  // Since C++ 17
 inline std::string_view  leftsv(const std::string& src,  size_t n) noexcept { return std::string_view(src.data(),n); }
@@ -100,7 +131,7 @@ inline std::string       ltrims (std::string_view sv)    noexcept;
 inline std::string       ltrims (const std::string& s)   noexcept { return ltrims(std::string_view{s}); }
 inline std::string_view  ltrimsv(std::string_view sv)    noexcept;
 inline std::string_view  ltrimsv(const std::string& s)   noexcept { return ltrimsv(std::string_view{s}); }
-inline std::string&      ltrimrf(std::string& s)         noexcept { s.erase(s.begin(), std::find_if_not(s.begin(), s.end(), [](unsigned char c) {return std::isspace(c);})); return s; }
+inline std::string&      ltrimrf(std::string& s)         noexcept { s.erase(0, strscan::space_prefix(s.data(), s.size())); return s; }
 inline std::string_view& ltrimsvrf(std::string_view& sv) noexcept;
 //#define ltrimrf(src) ((src).erase(0, (src).find_first_not_of(SPACE_CHARS))) // My version
 
@@ -108,7 +139,7 @@ inline std::string       rtrims (std::string_view sv)    noexcept;
 inline std::string       rtrims (const std::string& s)   noexcept { return rtrims(std::string_view{s}); }
 inline std::string_view  rtrimsv(std::string_view sv)    noexcept;
 inline std::string_view  rtrimsv(const std::string& s)   noexcept { return rtrimsv(std::string_view{s}); }
-inline std::string&      rtrimrf(std::string& s)         noexcept { s.erase(std::find_if_not(s.rbegin(), s.rend(), [](unsigned char c) {return std::isspace(c);}).base(), s.end()); return s; }
+inline std::string&      rtrimrf(std::string& s)         noexcept { s.resize(strscan::space_suffix_trimmed(s.data(), s.size())); return s; }
 inline std::string_view& rtrimsvrf(std::string_view& sv) noexcept;
 //#define rtrimrf(src) (src.erase(src.find_last_not_of(SPACE_CHARS) + 1))    // My version
 
@@ -118,35 +149,88 @@ inline std::string_view  trimsv  (std::string_view sv)    noexcept;   // Deepsee
 inline std::string_view  trimsv  (const std::string& src) noexcept { return trimsv(std::string_view{src}); }
 inline std::string&      trimrf  (std::string& src)       noexcept;
 inline std::string_view& trimsvrf(std::string_view& sv)   noexcept { return ltrimsvrf(rtrimsvrf(sv)); }
+// Trim the characters of a compile-time set D = delims<"...">, eg. trimsv<delims<"\"' ">>(sv):
+template <typename D> requires is_delims_v<D> inline std::string_view ltrimsv(std::string_view sv) noexcept;
+template <typename D> requires is_delims_v<D> inline std::string_view rtrimsv(std::string_view sv) noexcept;
+template <typename D> requires is_delims_v<D> inline std::string_view trimsv (std::string_view sv) noexcept { return ltrimsv<D>(rtrimsv<D>(sv)); }
 
-inline std::string lcases (std::string_view   src) noexcept { std::string dst{}; dst.resize(src.size()); std::transform(src.cbegin(), src.cend(), dst.begin(), [](unsigned char c) noexcept -> char { return static_cast<char>(std::tolower(c)); }); return dst; }
+inline std::string lcases (std::string_view   src) noexcept { std::string dst(src.size(), '\0'); strscan::to_lower(src.data(), dst.data(), src.size()); return dst; }
 inline std::string lcases (const std::string& src) noexcept { return lcases(std::string_view{src}); }
-inline std::string ucases (std::string_view   src) noexcept { std::string dst{}; dst.resize(src.size()); std::transform(src.cbegin(), src.cend(), dst.begin(), [](unsigned char c) noexcept -> char { return static_cast<char>(std::toupper(c)); }); return dst; }
+inline std::string ucases (std::string_view   src) noexcept { std::string dst(src.size(), '\0'); strscan::to_upper(src.data(), dst.data(), src.size()); return dst; }
 inline std::string ucases (const std::string& src) noexcept { return ucases(std::string_view{src}); }
 // My version:
 //inline std::string& lcaserf(std::string& src) { std::transform(src.begin(), src.end(), src.begin(), ::tolower); return src; }
 //inline std::string& ucaserf(std::string& src) { std::transform(src.begin(), src.end(), src.begin(), ::toupper); return src; }
 // Deepseek version:
-inline std::string& lcaserf(std::string& str) noexcept { std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) -> char {return static_cast<char>(std::tolower(c));}); return str; }
-inline std::string& ucaserf(std::string& str) noexcept { std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) -> char {return static_cast<char>(std::toupper(c));}); return str; }
+//inline std::string& lcaserf(std::string& str) noexcept { std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) -> char {return static_cast<char>(std::tolower(c));}); return str; }
+//inline std::string& ucaserf(std::string& str) noexcept { std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) -> char {return static_cast<char>(std::toupper(c));}); return str; }
+// Case conversion is ASCII only and locale-free (vectorized by strscan):
+inline std::string& lcaserf(std::string& str) noexcept { strscan::to_lower(str.data(), str.data(), str.size()); return str; }
+inline std::string& ucaserf(std::string& str) noexcept { strscan::to_upper(str.data(), str.data(), str.size()); return str; }
+
+// ASCII case-insensitive comparing and searching without lowered copies:
+inline bool   iequals(std::string_view a, std::string_view b) noexcept { return a.size()==b.size() && strscan::iequal(a.data(), b.data(), a.size()); }
+inline size_t ifind  (std::string_view src, std::string_view sfind, size_t pos=0) noexcept;
+
+// Transparent case-insensitive hash/equal, eg. std::unordered_map<std::string, int, ci_hash, ci_equal>,
+// whose find() accepts a std::string_view:
+struct ci_hash;
+struct ci_equal { using is_transparent = void; bool operator()(std::string_view a, std::string_view b) const noexcept { return iequals(a,b); } };
+using TStrUoSetCI = std::unordered_set<std::string, ci_hash, ci_equal>;
 
 enum SplitOption: uint8_t {TRIM=1<<0,NOEMPTY=1<<1};
 using SplitOptions = std::bitset<8>;
 template <typename T> class  spliti;
 template <typename T> class  splitiv;  // Deepseek version
+
+template <typename Set> class basic_split_view;
+using split_view = basic_split_view<strscan::charset>;      // lazy, allocation-free form of splitsv
+template <typename Set> class basic_tokenizer;
+using tokenizer  = basic_tokenizer<strscan::charset>;       // reusable, indexed form of splitsv
+template <std::invocable<std::string_view> F> class split_stream;   // chunked input
+template <typename F> void    split_each(std::string_view src, const strscan::charset& delims, SplitOptions opt, F&& emit);
 template <typename T> inline TStrVec& splits (TStrVec& dst, const std::string& src, T delimiters, SplitOptions opt=0) noexcept;
 template <typename T> inline TStrVec  splits (const std::string& src, T delimiters, SplitOptions opt=0) noexcept { TStrVec dst; splits(dst,src,delimiters,opt); return dst; }
 template <typename T> inline TSvVec   splitsv(std::string_view src, T delimiters, SplitOptions opt=0) noexcept;
 template <typename T> inline TSvVec   splitsv(const std::string& src, T delimiters, SplitOptions opt=0) noexcept { return splitsv(std::string_view{src},delimiters,opt); }
+// With a compile-time delimiter set D = delims<"...">:
+template <typename D> requires is_delims_v<D> inline TStrVec& splits (TStrVec& dst, const std::string& src, SplitOptions opt=0) noexcept;
+template <typename D> requires is_delims_v<D> inline TStrVec  splits (const std::string& src, SplitOptions opt=0) noexcept { TStrVec dst; splits<D>(dst,src,opt); return dst; }
+template <typename D> requires is_delims_v<D> inline TSvVec   splitsv(std::string_view src, SplitOptions opt=0) noexcept;
+// Filling a caller's container, eg. a TSvSVec, or a TSvVec reused across lines. dst is cleared first.
+template <typename C> concept SvContainer = requires(C& c, std::string_view sv) { c.clear(); c.push_back(sv); }
+                                          && !std::convertible_to<C, std::string_view>;
+template <SvContainer C, typename T> inline C& splitsv(C& dst, std::string_view src, T delimiters, SplitOptions opt=0) noexcept;
+template <typename D, SvContainer C> requires is_delims_v<D> inline C& splitsv(C& dst, std::string_view src, SplitOptions opt=0) noexcept;
+// Multi-threaded splitsv for huge buffers: the input is cut at delimiters into one chunk per thread
+// (nthreads=0 for all cores) and the chunks are split concurrently. The tokens are exactly those of
+// splitsv(src, delimiters, opt), either concatenated or as the per-chunk vectors in order.
+// std::bad_alloc from any thread reaches the caller.
+template <typename T> inline TSvVec              splitsv_par   (std::string_view src, T delimiters, SplitOptions opt=0, unsigned nthreads=0);
+template <typename T> inline std::vector<TSvVec> splitsv_chunks(std::string_view src, T delimiters, SplitOptions opt=0, unsigned nthreads=0);
 
 template <typename T> inline TSvPair splitpairsv(std::string_view   src, T separator, bool itrim=true) noexcept;
 template <typename T> inline TSvPair splitpairsv(const std::string& src, T separator, bool itrim=true) noexcept { return splitpairsv(std::string_view{src},separator,itrim); }
 
+// A whole key-value list in one pass, eg. a query string "a=1&b=2&c=%20x" or a cookie header:
+class kvlist;
+// Decode %XX escapes, and '+' to ' ' if plus_space, appending to dst. A malformed escape is kept.
+std::string& percent_decode(std::string& dst, std::string_view src, bool plus_space=true);
+inline std::string percent_decode(std::string_view src, bool plus_space=true) { std::string dst; return percent_decode(dst, src, plus_space); }
+
 // find and replace all(not use <regex> library in small projects):
        std::string  replall(std::string_view src, std::string_view sfind, std::string_view swith);
 inline std::string  replall(const std::string& src, const std::string& sfind, const std::string& swith) { return replall(std::string_view(src), std::string_view(sfind), std::string_view(swith)); }
 inline std::string& replall(std::string& src, const char cfind, const char cwith) noexcept { std::replace(src.begin(),src.end(),cfind,cwith); return src; }
 
+// Compiled form of replall for one needle applied to many strings, with an in-place variant
+class replacer;
+
+// Replace many needles in one pass, eg. replall_multi(tmpl, {{"{{name}}", name}, {"{{host}}", host}}).
+// Compile a multi_replacer once to apply the same rules to many strings.
+class multi_replacer;
+inline std::string  replall_multi(std::string_view src, const std::vector<TSvPair>& rules);
+
 // Remove trailing comment started by the most right character mark, eg. '#' or ';'
 inline std::string_view  rmcommsv  (std::string_view  srcv, const char mark='#', bool itrim=true) noexcept;
 inline std::string_view& rmcommsvrf(std::string_view& srcv, const char mark='#', bool itrim=true) noexcept;
@@ -154,12 +238,25 @@ inline std::string_view& rmcommsvrf(std::string_view& srcv, const char mark='#',
 // string_view windows scanning marked by left and right marks:
 template <typename T1, typename T2> inline std::string_view lrmarksv (std::string_view sv, T1 leftmark, T2 rightmark, size_t begin_pos=0) noexcept;
 template <typename T1, typename T2> inline TSvVec           strwinsvv(std::string_view sv, T1 leftmark, T2 rightmark, size_t begin_pos=0) noexcept;
+template <SvContainer C, typename T1, typename T2> inline C& strwinsvv(C& dst, std::string_view sv, T1 leftmark, T2 rightmark, size_t begin_pos=0) noexcept;
 template <typename T1, typename T2> class strwinsv;
-inline TSvVec multiwinsvv(std::string_view sv, const std::vector<TSvPair> lrmarks, size_t begin_pos=0) noexcept;
+inline TSvVec multiwinsvv(std::string_view sv, const std::vector<TSvPair>& lrmarks, size_t begin_pos=0) noexcept;
+template <SvContainer C> inline C& multiwinsvv(C& dst, std::string_view sv, const std::vector<TSvPair>& lrmarks, size_t begin_pos=0) noexcept;
+// multiwinsvv with the marks compiled once, for extracting the same fields from many lines
+class multiwin_extractor;
+
+// Quote-aware CSV/TSV records, from a buffer (csv_reader) or from chunks (csv_stream):
+struct csv_dialect;
+class  csv_reader;
+template <std::invocable<const TSvVec&> F> class csv_stream;
 
 // Password generating and checking:
 enum class PasswordSecurityLevel {LOW,MEDIUM,HIGH};
 std::string genPassword(PasswordSecurityLevel level=PasswordSecurityLevel::MEDIUM, size_t length=8);
+// n passwords back to back in one buffer, password i at [i*len, (i+1)*len) where len is length raised
+// to the level's minimum like genPassword does. Random bytes come from the OS CSPRNG (getrandom).
+std::string  genPasswords(size_t n, PasswordSecurityLevel level=PasswordSecurityLevel::MEDIUM, size_t length=8);
+std::string& genPasswords(std::string& dst, size_t n, PasswordSecurityLevel level=PasswordSecurityLevel::MEDIUM, size_t length=8);
 bool        chkPassword(std::string_view password, PasswordSecurityLevel level, size_t min_length=4);
 
 // Convert a string_view into an integer without error message and exception:
@@ -169,6 +266,25 @@ template<Integer T> inline std::optional<T> str2int(const std::string& s, std::o
 
 template<Integer T> inline bool from_c_succ(const char* first, const char* last, T& value, int base=10) noexcept
     { auto [ptr,ec] = std::from_chars(first, last, value, base); return ec==std::errc{} && ptr==last; }
+template<std::floating_point T> inline bool from_c_succ(const char* first, const char* last, T& value) noexcept
+    { auto [ptr,ec] = std::from_chars(first, last, value); return ec==std::errc{} && ptr==last; }
+
+// Convert a string_view into a floating point number in the same way as str2int:
+template<std::floating_point T> inline std::optional<T> str2float(std::string_view sv, std::optional<T> minvalue={}, std::optional<T> maxvalue={}) noexcept;
+
+// Bulk parsing of delimited numbers, eg. a CSV column. Fields are split like splitsv(sv, delim, opt)
+// and converted like str2int/str2float; the values are appended to out. Parsing stops at the first
+// field that fails, whose offset in sv is reported in errpos.
+struct parse_status {
+    size_t parsed{};                            // values appended to out
+    size_t errpos{std::string_view::npos};      // offset of the first failing field
+
+    [[nodiscard]] bool ok() const noexcept { return npossv(errpos); }
+};
+template<Integer T, typename D> inline parse_status parse_ints(std::string_view sv, D delim, std::vector<T>& out, SplitOptions opt=0,
+    std::optional<T> minvalue={}, std::optional<T> maxvalue={}, int base=10) noexcept;
+template<std::floating_point T, typename D> inline parse_status parse_floats(std::string_view sv, D delim, std::vector<T>& out, SplitOptions opt=0,
+    std::optional<T> minvalue={}, std::optional<T> maxvalue={}) noexcept;
 
 //------------------------------------------------------------------------------------------------
 // My version (for compatibility)
@@ -260,12 +376,255 @@ public:
     // 高效范围访问
     template <typename F>
     void for_each(F&& callback) const {
+        const strscan::charset delims{delimiters_};
+        strscan::cursor cur(sv_, delims);
         size_t start{};
-        sv_.find_first_of(delimiters_, 0, [&](size_t found) {
+        for (size_t found = cur.next(); !npossv(found); found = cur.next()) {
             callback(sv_.substr(start, found - start));
             start = found + 1;
-            return false; // 继续查找
-        });
+        }
+        callback(sv_.substr(start));
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+// Lazy tokenizer: yields std::string_view tokens on demand with no allocation, honouring TRIM and
+// NOEMPTY exactly like splitsv. Delimiters are located 64 bytes at a time by strscan.
+// Set is strscan::charset for delimiters given at run time (split_view), or a delims<...> type whose
+// set is built at compile time. The view does not own src, and the iterators of a split_view use the
+// view's delimiter set, so keep both alive while iterating. Eg.
+//      for (auto tok : split_view(line, " \t,;", SplitOption::NOEMPTY) | std::views::take(3)) ...
+//      for (auto tok : basic_split_view<delims<" \t,;">>(line)) ...
+template <typename Set>
+class basic_split_view : public std::ranges::view_interface<basic_split_view<Set>> {
+private:
+    static constexpr bool fixed {is_delims_v<Set>};
+
+    std::string_view src_;
+    Set delims_{};              // empty for a compile-time set
+    bool itrim_{};
+    bool noempty_{};
+
+public:
+    class iterator {
+    private:
+        using cursor_type = typename delims_traits<Set>::cursor_type;
+
+        std::string_view src_;
+        cursor_type cur_;
+        std::string_view tok_;
+        size_t next_{};         // start of the token after tok_, src_.size()+1 after the last one
+        bool itrim_{};
+        bool noempty_{};
+        bool done_{true};
+
+        static cursor_type make_cursor(const basic_split_view& parent) noexcept {
+            if constexpr (fixed) return cursor_type(parent.src_);
+            else                 return cursor_type(parent.src_, parent.delims_);
+        }
+
+        void advance() noexcept {
+            while (true) {
+                if (next_ > src_.size()) { done_ = true; return; }
+                const size_t end {cur_.next()};
+                const size_t stop {npossv(end)? src_.size() : end};
+                tok_ = std::string_view(src_.data()+next_, stop-next_);
+                next_ = stop+1;
+                if( itrim_ ) trimsvrf(tok_);
+                if( !tok_.empty() || !noempty_ ) return;
+            }
+        }
+
+    public:
+        using iterator_concept  = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(const basic_split_view& parent) noexcept
+            : src_(parent.src_), cur_(make_cursor(parent)),
+              itrim_(parent.itrim_), noempty_(parent.noempty_), done_(parent.src_.empty())
+            { if (!done_) advance(); }
+
+        std::string_view operator*() const noexcept { return tok_; }
+        iterator& operator++()    noexcept { advance(); return *this; }
+        iterator  operator++(int) noexcept { auto tmp{*this}; advance(); return tmp; }
+
+        friend bool operator==(const iterator& a, const iterator& b) noexcept
+            { return a.done_ == b.done_ && (a.done_ || a.next_ == b.next_); }
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept { return it.done_; }
+    };
+
+    basic_split_view() = default;
+
+    // delimiters: a char, a string of delimiter chars, a strscan::charset or a delims<...> object
+    template <typename T> requires (!fixed && std::constructible_from<strscan::charset, const T&>)
+    basic_split_view(std::string_view src, const T& delimiters, SplitOptions opt=0) noexcept
+        : src_(src), delims_(delimiters), itrim_(opt[SplitOption::TRIM-1]), noempty_(opt[SplitOption::NOEMPTY-1]) {}
+
+    explicit basic_split_view(std::string_view src, SplitOptions opt=0) noexcept requires fixed
+        : src_(src), itrim_(opt[SplitOption::TRIM-1]), noempty_(opt[SplitOption::NOEMPTY-1]) {}
+
+    iterator begin() const noexcept { return iterator{*this}; }
+    std::default_sentinel_t end() const noexcept { return std::default_sentinel; }
+};
+
+//------------------------------------------------------------------------------------------------
+// Reusable tokenizer for splitting many strings of the same shape, eg. the lines of a log file:
+//      tokenizer tk(",", SplitOption::TRIM);
+//      for (auto line : lines) { tk.reset(line); use(tk[3], tk[7]); }
+// The tokens are those of splitsv(src, delimiters, opt). They are kept as uint32_t offsets and
+// lengths in two arrays whose capacity survives reset(), so no allocation happens once the
+// longest line has been seen. Indexing never throws: an index past size() gives an empty
+// view. The source is not copied and must outlive the use of the tokens.
+template <typename Set>
+class basic_tokenizer {
+private:
+    static constexpr bool fixed {is_delims_v<Set>};
+
+    Set delims_{};
+    SplitOptions opt_;
+    std::string_view src_;
+    std::vector<uint32_t> off_;
+    std::vector<uint32_t> len_;
+
+public:
+    class iterator {
+    private:
+        const basic_tokenizer* tk_{};
+        std::ptrdiff_t i_{};
+
+    public:
+        using iterator_concept  = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(const basic_tokenizer* tk, std::ptrdiff_t i) noexcept: tk_(tk), i_(i) {}
+
+        std::string_view operator*() const noexcept { return (*tk_)[static_cast<size_t>(i_)]; }
+        std::string_view operator[](difference_type n) const noexcept { return (*tk_)[static_cast<size_t>(i_+n)]; }
+
+        iterator& operator++()    noexcept { ++i_; return *this; }
+        iterator  operator++(int) noexcept { auto tmp{*this}; ++i_; return tmp; }
+        iterator& operator--()    noexcept { --i_; return *this; }
+        iterator  operator--(int) noexcept { auto tmp{*this}; --i_; return tmp; }
+        iterator& operator+=(difference_type n) noexcept { i_ += n; return *this; }
+        iterator& operator-=(difference_type n) noexcept { i_ -= n; return *this; }
+
+        friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(const iterator& a, const iterator& b) noexcept { return a.i_ - b.i_; }
+        friend bool operator== (const iterator& a, const iterator& b) noexcept { return a.i_ == b.i_; }
+        friend auto operator<=>(const iterator& a, const iterator& b) noexcept { return a.i_ <=> b.i_; }
+    };
+
+    // delimiters: a char, a string of delimiter chars or a strscan::charset
+    template <typename T> requires (!fixed && std::constructible_from<strscan::charset, const T&>)
+    explicit basic_tokenizer(const T& delimiters, SplitOptions opt=0) noexcept: delims_(delimiters), opt_(opt) {}
+
+    explicit basic_tokenizer(SplitOptions opt=0) noexcept requires fixed: opt_(opt) {}
+
+    // Split src, replacing the previous tokens. Returns false, leaving no token, if src is 4 GiB or
+    // more, which the 32-bit offsets cannot address.
+    bool reset(std::string_view src) noexcept {
+        off_.clear();
+        len_.clear();
+        src_ = src;
+        if (src.size() > std::numeric_limits<uint32_t>::max()) { src_ = {}; return false; }
+
+        const auto tokens = [&] {
+            if constexpr (fixed) return basic_split_view<Set>(src, opt_);
+            else                 return basic_split_view<Set>(src, delims_, opt_);
+        }();
+        for (const std::string_view sv : tokens) {
+            off_.push_back(static_cast<uint32_t>(sv.data() - src.data()));
+            len_.push_back(static_cast<uint32_t>(sv.size()));
+        }
+        return true;
+    }
+
+    size_t size()  const noexcept { return off_.size(); }
+    bool   empty() const noexcept { return off_.empty(); }
+    size_t capacity() const noexcept { return off_.capacity(); }
+    std::string_view source() const noexcept { return src_; }
+
+    std::string_view operator[](size_t n) const noexcept
+        { return n < off_.size()? std::string_view(src_.data()+off_[n], len_[n]) : std::string_view{}; }
+    std::string s(size_t n) const { return std::string((*this)[n]); }
+
+    // Position of the nth token in the source, npos if n is out of range
+    size_t offset(size_t n) const noexcept { return n < off_.size()? off_[n] : std::string_view::npos; }
+    size_t length(size_t n) const noexcept { return n < len_.size()? len_[n] : 0; }
+
+    iterator begin() const noexcept { return iterator(this, 0); }
+    iterator end()   const noexcept { return iterator(this, static_cast<std::ptrdiff_t>(off_.size())); }
+};
+
+//------------------------------------------------------------------------------------------------
+// Eager form of split_view shared by splits/splitsv: every token is passed to emit(std::string_view).
+template <typename F>
+void split_each(std::string_view src, const strscan::charset& delims, SplitOptions opt, F&& emit)
+{
+    for (const std::string_view sv : split_view(src, delims, opt)) emit(sv);
+}
+
+//------------------------------------------------------------------------------------------------
+// Streaming form of splitsv for input that arrives in chunks (eg. a huge file read 1 MiB at a
+// time). Tokens lying inside a chunk are passed to the callback as views into that chunk; only a
+// token crossing a chunk boundary is copied, so memory is bounded by the chunk and the longest
+// token, not by the input size. Call finish() after the last chunk to flush the final token.
+// The tokens are the same as splitsv() on the concatenated input. Eg. reading lines:
+//      split_stream lines('\n', [&](std::string_view line) { ... }, SplitOption::TRIM);
+//      while (size_t n = fread(buf, 1, sizeof(buf), fp)) lines.feed({buf, n});
+//      lines.finish();
+template <std::invocable<std::string_view> F>
+class split_stream {
+private:
+    strscan::charset delims_;
+    bool itrim_{};
+    bool noempty_{};
+    bool started_{};        // any byte fed since the last finish()
+    std::string carry_;     // head of the token crossing the chunk boundary
+    F callback_;
+
+    void emit(std::string_view sv) {
+        if( itrim_ ) trimsvrf(sv);
+        if( !sv.empty() || !noempty_ ) callback_(sv);
+    }
+
+public:
+    template <typename T> requires std::constructible_from<strscan::charset, const T&>
+    split_stream(const T& delimiters, F callback, SplitOptions opt=0)
+        : delims_(delimiters), itrim_(opt[SplitOption::TRIM-1]), noempty_(opt[SplitOption::NOEMPTY-1]),
+          callback_(std::move(callback)) {}
+
+    void feed(std::string_view chunk) {
+        if (chunk.empty()) return;
+        started_ = true;
+
+        strscan::cursor cur(chunk, delims_);
+        size_t start{};
+        for (size_t found = cur.next(); !npossv(found); found = cur.next()) {
+            if (carry_.empty()) {
+                emit(chunk.substr(start, found - start));
+            } else {
+                carry_.append(chunk.data() + start, found - start);
+                emit(carry_);
+                carry_.clear();
+            }
+            start = found + 1;
+        }
+        carry_.append(chunk.data() + start, chunk.size() - start);
+    }
+
+    void finish() {
+        if (started_) emit(carry_);
+        carry_.clear();
+        started_ = false;
     }
 };
 
@@ -283,54 +642,17 @@ TStrVec& splits(TStrVec& dst, const std::string& src, T delimiters, SplitOptions
     // }
     // return dst;
 
-    // Deepseek optimized version:
     dst.clear();
     if (src.empty()) return dst;
 
-    const char* const data{src.data()};
-    const size_t src_len{src.size()};
-    size_t start{};
-
     // 预分配优化：根据经验值预留空间
     if (dst.capacity() < 16) {
-        dst.reserve(src_len / 8 + 2);  // 经验公式：每8字符一个分隔符
+        dst.reserve(src.size() / 8 + 2);  // 经验公式：每8字符一个分隔符
     }
 
-    // 类型分发优化
-    if constexpr (std::is_same_v<std::remove_cv_t<T>, char>) {
-        // 单字符分隔符优化路径
-        while (true) {
-            const size_t end {src.find(delimiters, start)};
-            const bool is_end {nposs(end)};
-            const size_t len {(is_end?src_len:end) - start};
-            std::string s(data+start, len);
-            if( opt[SplitOption::TRIM-1] ) trimrf(s);
-            if( !s.empty() || !opt[SplitOption::NOEMPTY-1] ) dst.push_back(move(s));
-            if( is_end ) break;
-            ++(start=end);
-        }
-    } else {
-        // 多字符分隔符处理
-        const std::string_view delims{delimiters};
-        const size_t delims_len{delims.length()};
-
-        // SIMD优化预处理（示例伪代码）
-        if (delims_len > 1 && (src_len > 256)) {
-            // 此处可添加SIMD加速查找逻辑
-        }
-
-        // 常规处理
-        while (true) {
-            const size_t end {src.find_first_of(delims, start)};
-            const bool is_end {nposs(end)};
-            const size_t len {(is_end?src_len:end) - start};
-            std::string s(data+start, len);
-            if( opt[SplitOption::TRIM-1] ) trimrf(s);
-            if( !s.empty() || !opt[SplitOption::NOEMPTY-1] ) dst.push_back(move(s));
-            if( is_end ) break;
-            ++(start=end);
-        }
-    }
+    // Trimming is done on the view, so a token string is built only once
+    const strscan::charset delims{delimiters};
+    split_each(src, delims, opt, [&dst](std::string_view sv) { dst.emplace_back(sv); });
 
     // 后置容量优化：避免过度预留
     if (dst.capacity() > dst.size() * 4) {
@@ -354,42 +676,117 @@ TSvVec splitsv(std::string_view src, T delimiters, SplitOptions opt) noexcept
     // }
     // return dst;
 
-    // Deepseek optimized version:
     TSvVec dst;
+    for (const std::string_view sv : split_view(src, delimiters, opt)) dst.push_back(sv);
+    return dst;
+}
+
+//------------------------------------------------------------------------------------------------
+template <typename D> requires is_delims_v<D>
+TStrVec& splits(TStrVec& dst, const std::string& src, SplitOptions opt) noexcept
+{
+    dst.clear();
     if (src.empty()) return dst;
+    if (dst.capacity() < 16) dst.reserve(src.size() / 8 + 2);
 
-    const char* const data{src.data()};
-    const size_t src_len {src.size()};
-    size_t start {};
+    for (const std::string_view sv : basic_split_view<D>(src, opt)) dst.emplace_back(sv);
 
-    // 类型分发优化
-    if constexpr (std::is_same_v<std::remove_cv_t<T>, char>) {
-        // 单字符分隔符优化路径
-        while (true) {
-            const size_t end {src.find(delimiters, start)};
-            const bool is_end  {npossv(end)};
-            const size_t len {(is_end? src_len:end) - start};
-            std::string_view sv(data+start, len);
-            if( opt[SplitOption::TRIM-1] ) trimsvrf(sv);
-            if( !sv.empty() || !opt[SplitOption::NOEMPTY-1] ) dst.push_back(sv);
-            if( is_end ) break;
-            ++(start=end);
-        }
-    } else {
-        // 通用分隔符处理
-        const std::string_view delims(delimiters);
-        while (true) {
-            const size_t end {src.find_first_of(delims, start)};
-            const bool is_end  {npossv(end)};
-            const size_t len {(is_end? src_len:end) - start};
-            std::string_view sv(data+start, len);
-            if( opt[SplitOption::TRIM-1] ) trimsvrf(sv);
-            if( !sv.empty() || !opt[SplitOption::NOEMPTY-1] ) dst.push_back(sv);
-            if( is_end ) break;
-            ++(start=end);
-        }
+    if (dst.capacity() > dst.size() * 4) dst.shrink_to_fit();
+    return dst;
+}
+
+//------------------------------------------------------------------------------------------------
+template <typename D> requires is_delims_v<D>
+TSvVec splitsv(std::string_view src, SplitOptions opt) noexcept
+{
+    TSvVec dst;
+    for (const std::string_view sv : basic_split_view<D>(src, opt)) dst.push_back(sv);
+    return dst;
+}
+
+//------------------------------------------------------------------------------------------------
+template <SvContainer C, typename T>
+C& splitsv(C& dst, std::string_view src, T delimiters, SplitOptions opt) noexcept
+{
+    dst.clear();
+    for (const std::string_view sv : split_view(src, delimiters, opt)) dst.push_back(sv);
+    return dst;
+}
+
+//------------------------------------------------------------------------------------------------
+template <typename D, SvContainer C> requires is_delims_v<D>
+C& splitsv(C& dst, std::string_view src, SplitOptions opt) noexcept
+{
+    dst.clear();
+    for (const std::string_view sv : basic_split_view<D>(src, opt)) dst.push_back(sv);
+    return dst;
+}
+
+//------------------------------------------------------------------------------------------------
+namespace impl {
+
+// Below this many bytes per thread, starting threads costs more than it saves
+inline constexpr size_t par_split_min_chunk = 1 << 20;
+
+// Chunks of src split at delimiters, [cuts[i]+1, cuts[i+1]) with cuts[0] = -1 and the last one
+// src.size(). Each cut is the first delimiter at or after an even share of the input.
+inline std::vector<size_t> par_split_cuts(std::string_view src, const strscan::charset& delims, unsigned nthreads)
+{
+    if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t nchunks {std::clamp<size_t>(src.size() / par_split_min_chunk, 1, nthreads)};
+
+    std::vector<size_t> cuts{std::string_view::npos};   // so that cuts[0]+1 == 0
+    for (size_t i = 1; i < nchunks; ++i) {
+        const size_t from {std::max(src.size() / nchunks * i, cuts.back() + 1)};
+        const size_t cut {strscan::find_first_of(src, delims, from)};
+        if (npossv(cut)) break;
+        cuts.push_back(cut);
     }
+    cuts.push_back(src.size());
+    return cuts;
+}
+
+// splitsv of one chunk. A chunk between two adjacent delimiters is empty, yet still holds one token.
+inline void par_split_chunk(TSvVec& dst, std::string_view chunk, const strscan::charset& delims, SplitOptions opt)
+{
+    if (chunk.empty()) { if (!opt[SplitOption::NOEMPTY-1]) dst.push_back(chunk); return; }
+    dst.reserve(chunk.size() / 8 + 2);
+    for (const std::string_view sv : split_view(chunk, delims, opt)) dst.push_back(sv);
+}
+
+} // namespace impl
+
+//------------------------------------------------------------------------------------------------
+template <typename T>
+std::vector<TSvVec> splitsv_chunks(std::string_view src, T delimiters, SplitOptions opt, unsigned nthreads)
+{
+    if (src.empty()) return {};
+
+    const strscan::charset delims{delimiters};
+    const std::vector<size_t> cuts {impl::par_split_cuts(src, delims, nthreads)};
+    std::vector<TSvVec> chunks(cuts.size() - 1);
+
+    impl::run_parallel(chunks.size(), [&](size_t i) {
+        impl::par_split_chunk(chunks[i], src.substr(cuts[i]+1, cuts[i+1]-cuts[i]-1), delims, opt);
+    });
+    return chunks;
+}
 
+//------------------------------------------------------------------------------------------------
+template <typename T>
+TSvVec splitsv_par(std::string_view src, T delimiters, SplitOptions opt, unsigned nthreads)
+{
+    std::vector<TSvVec> chunks {splitsv_chunks(src, delimiters, opt, nthreads)};
+    if (chunks.size() <= 1) return chunks.empty()? TSvVec{} : std::move(chunks[0]);
+
+    std::vector<size_t> start(chunks.size() + 1);      // where each chunk goes in the result
+    for (size_t i = 0; i < chunks.size(); ++i) start[i+1] = start[i] + chunks[i].size();
+
+    TSvVec dst(start.back());
+    impl::run_parallel(chunks.size(), [&](size_t i) {
+        std::copy(chunks[i].begin(), chunks[i].end(), dst.begin() + start[i]);
+        TSvVec{}.swap(chunks[i]);
+    });
     return dst;
 }
 
@@ -409,18 +806,10 @@ TSvVec splitsv(std::string_view src, T delimiters, SplitOptions opt) noexcept
 //     return src.substr(i, j-i+1);
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
+// White space is located by the strscan kernels for every trim function below
 std::string trims(std::string_view sv) noexcept
 {
-    auto first = std::find_if_not(sv.begin(), sv.end(),
-                [](unsigned char c) {return std::isspace(c);});
-
-    if (first == sv.end()) return {};
-
-    auto last = std::find_if_not(sv.rbegin(), sv.rend(),
-                [](unsigned char c) {return std::isspace(c);}).base();
-
-    return (first > last) ? std::string{} : std::string{first, last};
+    return std::string{trimsv(sv)};
 }
 
 //------------------------------------------------------------------------------------------------
@@ -439,20 +828,10 @@ std::string trims(std::string_view sv) noexcept
 //     return std::string_view(src.data()+i, j-i+1);
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
 std::string_view trimsv(std::string_view sv) noexcept
 {
-    if (sv.empty()) return sv;
-
-    auto first = std::find_if_not(sv.begin(), sv.end(), [](unsigned char c) {return std::isspace(c);});
-
-    if (first == sv.end()) return {};
-
-    auto last = std::find_if_not(sv.rbegin(), sv.rend(), [](unsigned char c) {return std::isspace(c);}).base();
-
-    return (first < last)
-        ? std::string_view{&*first, static_cast<size_t>(last - first)}
-        : std::string_view{};
+    const size_t first {strscan::space_prefix(sv.data(), sv.size())};
+    return sv.substr(first, strscan::space_suffix_trimmed(sv.data()+first, sv.size()-first));
 }
 
 //------------------------------------------------------------------------------------------------
@@ -465,15 +844,11 @@ std::string_view trimsv(std::string_view sv) noexcept
 //     return src;
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
+// In place, never reallocates
 std::string& trimrf(std::string& src) noexcept
 {
-    auto first = std::find_if_not(src.begin(),  src.end(),  [](unsigned char c) { return std::isspace(c); });
-    auto last  = std::find_if_not(src.rbegin(), src.rend(), [](unsigned char c) { return std::isspace(c); }).base();
-
-    // 触发移动语义优化
-    if (first < last) src = std::string(first, last); else src.clear();
-
+    src.resize(strscan::space_suffix_trimmed(src.data(), src.size()));
+    src.erase(0, strscan::space_prefix(src.data(), src.size()));
     return src;
 }
 
@@ -491,11 +866,9 @@ std::string& trimrf(std::string& src) noexcept
 //     return i>j? std::string() : src.substr(i);
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
 std::string ltrims(std::string_view sv) noexcept
 {
-    auto first = std::find_if_not(sv.begin(), sv.end(), [](unsigned char c) { return std::isspace(c); });
-    return (first != sv.end())? std::string(first, sv.end()) : std::string{};
+    return std::string{sv.substr(strscan::space_prefix(sv.data(), sv.size()))};
 }
 
 //------------------------------------------------------------------------------------------------
@@ -512,17 +885,15 @@ std::string ltrims(std::string_view sv) noexcept
 //     return i>j? std::string_view() : std::string_view(src.data()+i, src.size()-i);
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
 std::string_view ltrimsv(std::string_view sv) noexcept
 {
-    auto first = std::find_if_not(sv.begin(), sv.end(), [](unsigned char c) { return std::isspace(c); });
-    return (first != sv.end())? sv.substr(static_cast<size_t>(first - sv.begin())) : std::string_view{};
+    return sv.substr(strscan::space_prefix(sv.data(), sv.size()));
 }
+
 //------------------------------------------------------------------------------------------------
 std::string_view& ltrimsvrf(std::string_view& sv) noexcept
 {
-    auto it = std::find_if_not(sv.begin(), sv.end(), [](unsigned char c) {return std::isspace(c);});
-    sv.remove_prefix(static_cast<size_t>(it - sv.begin()));
+    sv.remove_prefix(strscan::space_prefix(sv.data(), sv.size()));
     return sv;
 }
 
@@ -537,11 +908,9 @@ std::string_view& ltrimsvrf(std::string_view& sv) noexcept
 //     return r==src.rend()? std::string() : src.substr(0, src.size()-(r-src.rbegin()));
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
 std::string rtrims(std::string_view sv) noexcept
 {
-    auto last = std::find_if_not(sv.rbegin(), sv.rend(), [](unsigned char c) { return std::isspace(c); }).base();
-    return (last > sv.begin())? std::string(sv.begin(), last) : std::string{};
+    return std::string{sv.substr(0, strscan::space_suffix_trimmed(sv.data(), sv.size()))};
 }
 
 //------------------------------------------------------------------------------------------------
@@ -555,38 +924,53 @@ std::string rtrims(std::string_view sv) noexcept
 //     return r==src.rend()? std::string_view() : std::string_view(src.data(), src.size()-(r-src.rbegin()));
 // }
 //------------------------------------------------------------------------------------------------
-// Deepseek version
 std::string_view rtrimsv(std::string_view sv) noexcept
 {
-    auto last = std::find_if_not(sv.rbegin(), sv.rend(), [](unsigned char c) { return std::isspace(c); }).base();
-    return (last > sv.begin()) ? sv.substr(0, static_cast<size_t>(last - sv.begin())) : std::string_view{};
+    return sv.substr(0, strscan::space_suffix_trimmed(sv.data(), sv.size()));
 }
 
 //------------------------------------------------------------------------------------------------
 std::string_view& rtrimsvrf(std::string_view& sv) noexcept
 {
-    auto rit = std::find_if_not(sv.rbegin(), sv.rend(), [](unsigned char c) { return std::isspace(c); });
-    sv.remove_suffix(static_cast<size_t>(sv.end() - rit.base()));
+    sv.remove_suffix(sv.size() - strscan::space_suffix_trimmed(sv.data(), sv.size()));
     return sv;
 }
 
+//------------------------------------------------------------------------------------------------
+// Trimming a compile-time set rather than whitespace, eg. trimsv<delims<"\"' ">>(sv). The scan
+// kernel is chosen at compile time from the set, as for splitsv<D>: see strscan::member_prefix.
+template <typename D> requires is_delims_v<D>
+std::string_view ltrimsv(std::string_view sv) noexcept
+{
+    return sv.substr(strscan::member_prefix<D::set>(sv.data(), sv.size()));
+}
+
+//------------------------------------------------------------------------------------------------
+template <typename D> requires is_delims_v<D>
+std::string_view rtrimsv(std::string_view sv) noexcept
+{
+    return sv.substr(0, strscan::member_suffix_trimmed<D::set>(sv.data(), sv.size()));
+}
+
 //------------------------------------------------------------------------------------------------
 template <typename T1, typename T2>
 class strwinsv {
 private:
-    std::string_view src;
-    T1 leftmark;
-    T2 rightmark;
-    size_t current_pos{};
+    // A char mark stays a char for the single-byte find(), any string mark becomes a string_view
+    template <typename T>
+    using mark_t = std::conditional_t<std::is_same_v<std::remove_cv_t<T>, char>, char, std::string_view>;
 
     template <typename T>
-    size_t find_mark(T mark, size_t pos) const {
-        if constexpr (std::is_same_v<std::remove_cv_t<T>, char>)
-            return src.find(mark, pos);
-        else
-            return src.find(std::string_view(mark), pos);
+    static constexpr size_t mark_size(T mark) noexcept {
+        if constexpr (std::is_same_v<T, char>) return 1;
+        else                                   return mark.size();
     }
 
+    std::string_view src;
+    mark_t<T1> leftmark;
+    mark_t<T2> rightmark;
+    size_t current_pos{};
+
 public:
     std::string_view winsv;
 
@@ -594,25 +978,15 @@ public:
         : src(s), leftmark(lm), rightmark(rm), current_pos(begin_pos) {}
 
     bool next() {
-        const auto lpos {find_mark(leftmark, current_pos)};
+        const auto lpos {src.find(leftmark, current_pos)};
         if (npossv(lpos)) return false;
 
-        size_t start {lpos};
-        if constexpr (std::is_same_v<std::remove_cv_t<T1>, char>)
-            start += 1;
-        else
-            start += leftmark.size();
-
-        const auto rpos = find_mark(rightmark, start);
+        const size_t start {lpos + mark_size(leftmark)};
+        const auto rpos = src.find(rightmark, start);
         if (npossv(rpos)) return false;
 
         winsv = src.substr(start, rpos - start);
-
-        if constexpr (std::is_same_v<std::remove_cv_t<T2>, char>)
-            current_pos = rpos + 1;
-        else
-            current_pos = rpos + rightmark.size();
-
+        current_pos = rpos + mark_size(rightmark);
         return true;
     }
 };
@@ -657,6 +1031,16 @@ TSvVec strwinsvv(std::string_view sv, T1 leftmark, T2 rightmark, size_t begin_po
     return results;
 }
 
+//------------------------------------------------------------------------------------------------
+template <SvContainer C, typename T1, typename T2>
+C& strwinsvv(C& dst, std::string_view sv, T1 leftmark, T2 rightmark, size_t begin_pos) noexcept
+{
+    dst.clear();
+    strwinsv<T1, T2> scanner(sv, leftmark, rightmark, begin_pos);
+    while (scanner.next()) dst.push_back(scanner.winsv);
+    return dst;
+}
+
 //------------------------------------------------------------------------------------------------
 // Caution: The separator is either a character or a STRING. Eg.
 //      splitpairsv("key=value", '=');        // {"key", "value"}
@@ -685,6 +1069,313 @@ TSvPair splitpairsv(std::string_view src, T separator, bool itrim) noexcept
     };
 }
 
+//------------------------------------------------------------------------------------------------
+// replall with the needle compiled once (Horspool skip table), so it can be applied to millions of
+// strings. replace() returns a new string, replacerf() edits the buffer directly without any match
+// vector: compacting forward when shrinking; when growing, counting the matches, resizing once,
+// moving the text to the tail of the buffer and compacting forward from there.
+class replacer {
+private:
+    std::string find_;
+    std::string with_;
+    size_t skip_[256]{};
+
+public:
+    replacer(std::string_view sfind, std::string_view swith);
+
+    // Position of the first match at or after pos, or npos
+    size_t find(std::string_view src, size_t pos=0) const noexcept;
+    size_t count(std::string_view src) const noexcept;
+
+    std::string  replace  (std::string_view src) const;
+    std::string& replacerf(std::string& src) const;
+};
+
+//------------------------------------------------------------------------------------------------
+// Aho-Corasick automaton over a fixed list of {find, with} rules. replace() performs all
+// non-overlapping leftmost-longest replacements in a single scan of src: the earliest starting
+// match wins, and among matches starting at the same byte the longest one. Empty needles are
+// ignored; for duplicated needles the first rule is used.
+// The rules are copied, so the views passed in need not outlive the object.
+class multi_replacer {
+private:
+    struct rule {
+        uint32_t find_len;
+        uint32_t with_pos;      // offset in with_
+        uint32_t with_len;
+    };
+
+    std::vector<rule>     rules_;
+    std::string           with_;        // all replacement strings back to back
+    uint16_t              cls_[256]{};  // byte -> equivalence class, 0 for bytes in no needle
+    size_t                nclass_{1};
+    std::vector<uint32_t> delta_;       // state * nclass_ + class -> next state
+    std::vector<uint32_t> depth_;       // length of the prefix a state stands for
+    std::vector<uint32_t> out_;         // 1 + index of the longest rule ending at a state, or 0
+    strscan::charset      first_;       // first bytes of the needles, used to skip from the root
+    size_t                min_find_{};
+    size_t                max_growth_{};
+
+    template <typename F> void scan(std::string_view src, F&& on_match) const;
+
+public:
+    explicit multi_replacer(const std::vector<TSvPair>& rules);
+
+    bool empty() const noexcept { return rules_.empty(); }
+
+    // Number of replacements replace() would make
+    size_t count(std::string_view src) const noexcept;
+    // The result is allocated once: by a bound when no rule grows by more than the shortest
+    // needle's length (at most twice src), otherwise exactly, by a counting pass first.
+    std::string replace(std::string_view src) const;
+};
+
+inline std::string replall_multi(std::string_view src, const std::vector<TSvPair>& rules)
+{
+    return multi_replacer(rules).replace(src);
+}
+
+//------------------------------------------------------------------------------------------------
+// multiwinsvv compiled for a fixed list of {left, right} marks, eg. pulling user=[...] and rt="..."
+// out of every line of a log:
+//      static const multiwin_extractor ex({{"user=[", "]"}, {"rt=\"", "\""}});
+//      std::string_view f[2];
+//      for (auto line : lines) if (ex.extract(line, f) == 2) use(f[0], f[1]);
+// The windows are the same as multiwinsvv(line, lrmarks): each pair is searched from the end of
+// the previous window found, and a pair that is not found gives an empty view. The marks are
+// copied, and each is searched by its rarest byte (memchr) verified by memcmp, so a line is
+// walked forward once when all the marks are present.
+class multiwin_extractor {
+private:
+    struct mark {
+        uint32_t pos;       // offset in marks_
+        uint32_t len;
+        uint32_t anchor;    // offset of the byte memchr looks for, within the mark
+    };
+
+    std::string marks_;
+    std::vector<mark> left_;
+    std::vector<mark> right_;
+
+    mark add_mark(std::string_view sv);
+    size_t find(std::string_view src, const mark& m, size_t pos) const noexcept;
+
+public:
+    explicit multiwin_extractor(const std::vector<TSvPair>& lrmarks);
+
+    size_t size() const noexcept { return left_.size(); }
+
+    // Writes size() windows to out, returns how many pairs were found
+    size_t extract(std::string_view src, std::string_view* out, size_t begin_pos=0) const noexcept;
+    template <SvContainer C>
+    C& extract(C& dst, std::string_view src, size_t begin_pos=0) const noexcept;
+};
+
+template <SvContainer C>
+C& multiwin_extractor::extract(C& dst, std::string_view src, size_t begin_pos) const noexcept
+{
+    dst.clear();
+    size_t pos {begin_pos};
+    for (size_t i = 0; i < left_.size(); ++i) {
+        const size_t lpos {find(src, left_[i], pos)};
+        if (npossv(lpos)) { dst.push_back({}); continue; }
+        const size_t start {lpos + left_[i].len};
+        const size_t rpos {find(src, right_[i], start)};
+        if (npossv(rpos)) { dst.push_back({}); continue; }
+        dst.push_back(src.substr(start, rpos - start));
+        pos = rpos + right_[i].len;
+    }
+    return dst;
+}
+
+//------------------------------------------------------------------------------------------------
+// Parsed key-value list: pairs separated by any of pair_seps, key and value by the first kv_sep.
+// Empty pairs are skipped, and a pair without kv_sep has an empty value. Eg.
+//      kvlist q;               // query string: "&", '=', '+' is a space
+//      q.parse("a=1&b=2&c=%20x+y");
+//      q.find("c");            // " x y"
+//      kvlist cookies("; ", '=', false);
+// parse() classifies the input 64 bytes at a time for the separators, '%' and '+', so it also
+// learns which keys and values hold escapes. Those are decoded on first access into a string
+// owned by the kvlist; all other keys and values are views into the source, which must outlive
+// the kvlist. The returned views stay valid until the next parse(). Only for single thread usage,
+// as access may decode.
+class kvlist {
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+    struct entry {
+        std::string_view key;
+        std::string_view value;
+        bool key_escaped;
+        bool value_escaped;
+        mutable uint32_t key_decoded{none};     // index in decoded_, once decoded
+        mutable uint32_t value_decoded{none};
+    };
+
+    strscan::charset scan_;     // pair_seps, kv_sep, '%' and '+'
+    strscan::charset pair_seps_;
+    char kv_sep_;
+    bool plus_space_;
+    std::vector<entry> entries_;
+    mutable std::deque<std::string> decoded_;   // never moves its strings
+
+    std::string_view decode(std::string_view raw, bool escaped, uint32_t& idx) const;
+
+public:
+    explicit kvlist(std::string_view pair_seps="&", char kv_sep='=', bool plus_space=true);
+
+    // Replaces the previous pairs, returns the number of pairs
+    size_t parse(std::string_view src);
+
+    size_t size()  const noexcept { return entries_.size(); }
+    bool   empty() const noexcept { return entries_.empty(); }
+
+    // As in the source, still escaped
+    std::string_view raw_key  (size_t i) const noexcept { return entries_[i].key; }
+    std::string_view raw_value(size_t i) const noexcept { return entries_[i].value; }
+
+    // Decoded
+    std::string_view key  (size_t i) const { const entry& e {entries_[i]}; return decode(e.key,   e.key_escaped,   e.key_decoded); }
+    std::string_view value(size_t i) const { const entry& e {entries_[i]}; return decode(e.value, e.value_escaped, e.value_decoded); }
+    TSvPair operator[](size_t i) const { return {key(i), value(i)}; }
+
+    // Decoded value of the first pair whose decoded key is key
+    std::optional<std::string_view> find(std::string_view key) const;
+};
+
+//------------------------------------------------------------------------------------------------
+// sep separates fields and '\n' (or "\r\n") records. A field starting with quote may hold sep, new
+// lines and doubled quotes ("" for "). quote = '\0' turns quoting off, eg. for plain TSV.
+struct csv_dialect {
+    char sep   {','};
+    char quote {'"'};
+};
+inline constexpr csv_dialect CSV_DIALECT {',', '"'};
+inline constexpr csv_dialect TSV_DIALECT {'\t', '\0'};
+
+//------------------------------------------------------------------------------------------------
+// CSV/TSV records over a buffer, eg. a whole file in memory or mapped:
+//      csv_reader rd(text);
+//      TSvVec row;
+//      while (rd.next(row)) use(row[0], row[3]);
+// 64 bytes are classified at a time (simdcsv style): SIMD compares give the quote, sep and '\n'
+// masks, a prefix XOR of the quote mask gives the bytes inside quotes, and the separators and new
+// lines outside quotes are then taken one by one with count-trailing-zeros.
+// Fields are views into the buffer with their quotes removed. Only a field holding an escaped
+// quote is copied, unescaped, into an arena reused by every record, so the views of a record stay
+// valid until the next call of next(). A blank line is a record with no field. Malformed quoting
+// is read leniently: a quote opens or closes quoting wherever it appears, so "ab"cd gives abcd.
+class csv_reader {
+private:
+    std::string_view src_;
+    csv_dialect d_;
+    bool final_{true};
+    size_t pos_{};              // start of the next record
+    size_t row_end_{};          // end of the current record, without "\r\n"
+
+    // Scanner state
+    size_t block_{};            // offset of the block held in mask_
+    uint64_t mask_{};           // separators and new lines outside quotes, not yet consumed
+    uint64_t in_quote_{};       // all ones if the block before block_+64 ends inside quotes
+
+    std::vector<size_t> ends_;  // field ends of the current record
+    std::string arena_;
+
+    void load() noexcept;
+    size_t next_structural() noexcept;
+    bool next_record();
+    std::string_view field(size_t begin, size_t end);
+
+public:
+    explicit csv_reader(csv_dialect d=CSV_DIALECT) noexcept: d_(d) {}
+    explicit csv_reader(std::string_view src, csv_dialect d=CSV_DIALECT) noexcept: d_(d) { reset(src); }
+
+    // Restart on a new buffer, keeping the capacity of the internal vectors. With final=false the
+    // buffer is a prefix of the input: a last record that is not ended by a new line is left for
+    // the caller to complete, see position().
+    void reset(std::string_view src, bool final=true) noexcept;
+
+    // Fields of the next record into dst (cleared first), false at the end of the buffer
+    template <SvContainer C> bool next(C& dst);
+
+    // Offset of the first byte not consumed yet
+    size_t position() const noexcept { return pos_; }
+};
+
+template <SvContainer C>
+bool csv_reader::next(C& dst)
+{
+    dst.clear();
+    if (!next_record()) return false;
+
+    size_t begin {pos_};
+    for (size_t i = 0; i < ends_.size(); ++i) {
+        const size_t end {i + 1 == ends_.size()? row_end_ : ends_[i]};
+        dst.push_back(field(begin, end));
+        begin = end + 1;
+    }
+    if (dst.size() == 1 && row_end_ == pos_) dst.clear();  // blank line
+    pos_ = std::min(ends_.back() + 1, src_.size());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------
+// Streaming form of csv_reader for input that arrives in chunks, eg. a huge file read 1 MiB at a
+// time. Records inside a chunk are parsed in place; only a record crossing a chunk boundary is
+// copied. The callback receives the fields of each record, valid during the call. Eg.
+//      csv_stream rows([&](const TSvVec& row) { ... });
+//      while (size_t n = fread(buf, 1, sizeof(buf), fp)) rows.feed({buf, n});
+//      rows.finish();
+template <std::invocable<const TSvVec&> F>
+class csv_stream {
+private:
+    csv_reader reader_;
+    TSvVec fields_;
+    std::string carry_;     // head of the record crossing the chunk boundary
+    char quote_;
+    bool carry_quoted_{};   // carry_ ends inside quotes: an odd number of quote chars
+    F callback_;
+
+    bool odd_quotes(std::string_view sv) const noexcept {
+        return quote_ && (std::count(sv.begin(), sv.end(), quote_) & 1);
+    }
+
+public:
+    explicit csv_stream(F callback, csv_dialect d=CSV_DIALECT): reader_(d), quote_(d.quote), callback_(std::move(callback)) {}
+
+    void feed(std::string_view chunk) {
+        size_t off{};
+        // Complete the carried record one line at a time. The quote parity is carried along, as
+        // csv_reader's prefix XOR does, so the record is parsed once, at the first new line
+        // outside quotes, however many lines and chunks it spans.
+        while (!carry_.empty()) {
+            const size_t nl {chunk.find('\n', off)};
+            const std::string_view line {chunk.substr(off, npossv(nl)? std::string_view::npos : nl + 1 - off)};
+            carry_.append(line);
+            carry_quoted_ ^= odd_quotes(line);
+            if (npossv(nl)) return;
+            off = nl + 1;
+            if (carry_quoted_) continue;
+
+            reader_.reset(carry_, false);
+            while (reader_.next(fields_)) callback_(fields_);
+            carry_.clear();
+        }
+
+        reader_.reset(chunk.substr(off), false);
+        while (reader_.next(fields_)) callback_(fields_);
+        carry_.assign(chunk.substr(off + reader_.position()));
+        carry_quoted_ = odd_quotes(carry_);
+    }
+
+    void finish() {
+        reader_.reset(carry_, true);
+        while (reader_.next(fields_)) callback_(fields_);
+        carry_.clear();
+        carry_quoted_ = false;
+    }
+};
+
 //------------------------------------------------------------------------------------------------
 // If the first char is mark, the whole string is comment, otherwise the comment is from the most
 // right mark char to the end of the string.
@@ -710,6 +1401,136 @@ std::string_view& rmcommsvrf(std::string_view& srcv, const char mark, bool itrim
     return srcv;
 }
 
+//------------------------------------------------------------------------------------------------
+// The first byte is located by strscan in both cases, the rest is compared by strscan::iequal
+size_t ifind(std::string_view src, std::string_view sfind, size_t pos) noexcept
+{
+    if (sfind.empty()) return pos <= src.size()? pos : std::string_view::npos;
+    if (pos >= src.size() || src.size() - pos < sfind.size()) return std::string_view::npos;
+
+    strscan::charset first{strscan::lower(sfind[0])};
+    first.set(strscan::upper(sfind[0]));
+
+    const size_t last {src.size() - sfind.size()};
+    strscan::cursor cur(src.substr(0, last+1), first, pos);
+    for (size_t found = cur.next(); !npossv(found); found = cur.next())
+        if (strscan::iequal(src.data()+found+1, sfind.data()+1, sfind.size()-1)) return found;
+    return std::string_view::npos;
+}
+
+//------------------------------------------------------------------------------------------------
+namespace impl {
+
+// Hashes 8 bytes per step; fold may change each loaded word before it is mixed in
+template <typename Fold>
+inline size_t hash_words(std::string_view sv, Fold fold) noexcept
+{
+    const auto mix = [](uint64_t h, uint64_t w) noexcept {
+        return (std::rotl(h ^ w, 31) + w) * 0x9E3779B97F4A7C15ULL;
+    };
+
+    uint64_t h {sv.size() * 0xC2B2AE3D27D4EB4FULL};
+    size_t i{};
+    for (; i + 8 <= sv.size(); i += 8) {
+        uint64_t w;
+        std::memcpy(&w, sv.data()+i, 8);
+        h = mix(h, fold(w));
+    }
+    if (i < sv.size()) {
+        uint64_t w{};
+        std::memcpy(&w, sv.data()+i, sv.size()-i);
+        h = mix(h, fold(w));
+    }
+    return static_cast<size_t>(h ^ (h >> 29));
+}
+
+} // namespace impl
+
+// Transparent hash of TStrUoSet and friends, eg. std::unordered_map<std::string, int, str_hash, std::equal_to<>>
+struct str_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view sv) const noexcept { return impl::hash_words(sv, std::identity{}); }
+};
+
+// Folded to lower case with SWAR: a byte gets 0x20 or'ed in when it is in 'A'..'Z', ie. >= 'A'
+// and not > 'Z', and has no high bit.
+struct ci_hash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view sv) const noexcept {
+        constexpr uint64_t ones {0x0101010101010101ULL};
+        return impl::hash_words(sv, [](uint64_t w) noexcept {
+            const uint64_t low7 {w & (0x7F * ones)};
+            const uint64_t ge_a {low7 + (0x80 - 'A') * ones};
+            const uint64_t gt_z {low7 + (0x80 - 'Z' - 1) * ones};
+            return w | (((ge_a & ~gt_z & ~w) & (0x80 * ones)) >> 2);
+        });
+    }
+};
+
+//------------------------------------------------------------------------------------------------
+namespace impl {
+
+// SWAR test and conversion of 8 ASCII digits loaded little-endian (first char in the low byte)
+inline bool is_8digits(uint64_t w) noexcept
+{
+    return ((w & 0xF0F0F0F0F0F0F0F0ULL) | (((w + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+inline uint32_t parse_8digits(uint64_t w) noexcept
+{
+    constexpr uint64_t mask {0x000000FF000000FFULL};
+    constexpr uint64_t mul1 {100 + (1000000ULL << 32)};
+    constexpr uint64_t mul2 {1 + (10000ULL << 32)};
+    w -= 0x3030303030303030ULL;
+    w = (w * 10) + (w >> 8);                                        // 4 x 2 digits
+    return static_cast<uint32_t>((((w & mask) * mul1) + (((w >> 16) & mask) * mul2)) >> 32);
+}
+
+// Same result as from_c_succ(first, last, value, 10), converting 8 digits per step. Up to 19
+// digits fit in uint64_t, longer inputs are left to std::from_chars.
+template<Integer T>
+bool from_dec_succ(const char* first, const char* last, T& value) noexcept
+{
+    if constexpr (std::endian::native != std::endian::little || sizeof(T) > sizeof(uint64_t)) {
+        return from_c_succ(first, last, value, 10);
+    } else {
+        using U = std::make_unsigned_t<T>;
+        const char* p {first};
+        bool neg{};
+        if constexpr (std::is_signed_v<T>) if (p != last && *p == '-') { neg = true; ++p; }
+
+        const size_t n {static_cast<size_t>(last - p)};
+        if (n == 0) return false;
+        if (n > 19) return from_c_succ(first, last, value, 10);
+
+        uint64_t v{};
+        size_t i{};
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            if (!is_8digits(w)) return false;
+            v = v * 100000000 + parse_8digits(w);
+        }
+        for (; i < n; ++i) {
+            const unsigned d {static_cast<unsigned char>(p[i] - '0')};
+            if (d > 9) return false;
+            v = v * 10 + d;
+        }
+
+        if (neg) {
+            if (v > uint64_t{static_cast<U>(std::numeric_limits<T>::max())} + 1) return false;
+            value = static_cast<T>(0 - v);      // modular conversion, exact for the minimum value
+        } else {
+            if (v > uint64_t{static_cast<U>(std::numeric_limits<T>::max())}) return false;
+            value = static_cast<T>(v);
+        }
+        return true;
+    }
+}
+
+} // namespace impl
+
 //------------------------------------------------------------------------------------------------
 template<Integer T>
 std::optional<T> str2int(std::string_view sv, std::optional<T> minvalue, std::optional<T> maxvalue, int base) noexcept
@@ -717,7 +1538,7 @@ std::optional<T> str2int(std::string_view sv, std::optional<T> minvalue, std::op
     if (sv.empty()) return std::nullopt;
 
     T value{};
-    if( !from_c_succ(sv.data(), sv.data()+sv.size(), value, base)
+    if( !(base==10? impl::from_dec_succ(sv.data(), sv.data()+sv.size(), value) : from_c_succ(sv.data(), sv.data()+sv.size(), value, base))
         || (minvalue.has_value() && value < minvalue.value())
         || (maxvalue.has_value() && value > maxvalue.value())
     ) return std::nullopt;
@@ -725,6 +1546,55 @@ std::optional<T> str2int(std::string_view sv, std::optional<T> minvalue, std::op
     return value;
 }
 //------------------------------------------------------------------------------------------------
+template<std::floating_point T>
+std::optional<T> str2float(std::string_view sv, std::optional<T> minvalue, std::optional<T> maxvalue) noexcept
+{
+    if (sv.empty()) return std::nullopt;
+
+    T value{};
+    if( !from_c_succ(sv.data(), sv.data()+sv.size(), value)
+        || (minvalue.has_value() && value < minvalue.value())
+        || (maxvalue.has_value() && value > maxvalue.value())
+    ) return std::nullopt;
+
+    return value;
+}
+//------------------------------------------------------------------------------------------------
+// Fields are located by split_view, so delimiters are found 64 bytes at a time
+template<Integer T, typename D>
+parse_status parse_ints(std::string_view sv, D delim, std::vector<T>& out, SplitOptions opt,
+    std::optional<T> minvalue, std::optional<T> maxvalue, int base) noexcept
+{
+    parse_status status{};
+    for (const std::string_view field : split_view(sv, delim, opt)) {
+        const std::optional<T> value {str2int(field, minvalue, maxvalue, base)};
+        if (!value.has_value()) {
+            status.errpos = static_cast<size_t>(field.data() - sv.data());
+            break;
+        }
+        out.push_back(*value);
+        ++status.parsed;
+    }
+    return status;
+}
+//------------------------------------------------------------------------------------------------
+template<std::floating_point T, typename D>
+parse_status parse_floats(std::string_view sv, D delim, std::vector<T>& out, SplitOptions opt,
+    std::optional<T> minvalue, std::optional<T> maxvalue) noexcept
+{
+    parse_status status{};
+    for (const std::string_view field : split_view(sv, delim, opt)) {
+        const std::optional<T> value {str2float(field, minvalue, maxvalue)};
+        if (!value.has_value()) {
+            status.errpos = static_cast<size_t>(field.data() - sv.data());
+            break;
+        }
+        out.push_back(*value);
+        ++status.parsed;
+    }
+    return status;
+}
+//------------------------------------------------------------------------------------------------
 template <typename T1, typename T2>
 T1 left_of(const T1& src, T2 mark, bool return_empty_if_not_found) noexcept
 {
@@ -769,27 +1639,35 @@ std::string&  erase_right_at(std::string& src, T2 mark) noexcept
     return str_found(lpos)? src.erase(lpos) : src;
 }
 //------------------------------------------------------------------------------------------------
-TSvVec multiwinsvv(std::string_view sv, const std::vector<TSvPair> lrmarks, size_t begin_pos) noexcept
+TSvVec multiwinsvv(std::string_view sv, const std::vector<TSvPair>& lrmarks, size_t begin_pos) noexcept
 {
     TSvVec results;
     results.reserve(lrmarks.size());
+    return multiwinsvv(results, sv, lrmarks, begin_pos);
+}
+
+//------------------------------------------------------------------------------------------------
+template <SvContainer C>
+C& multiwinsvv(C& dst, std::string_view sv, const std::vector<TSvPair>& lrmarks, size_t begin_pos) noexcept
+{
+    dst.clear();
     size_t current_search_pos {begin_pos};
 
     for (const auto& [left_mark,right_mark] : lrmarks) {
         const size_t lpos {sv.find(left_mark, current_search_pos)};
         if (npossv(lpos)) {
-            results.emplace_back();
+            dst.push_back({});
             continue;
         }
         const size_t start_content_pos {lpos + left_mark.length()};
         const size_t rpos {sv.find(right_mark, start_content_pos)};
         if (npossv(rpos)) {
-            results.emplace_back();
+            dst.push_back({});
             continue;
         }
-        results.emplace_back(sv.substr(start_content_pos, rpos - start_content_pos));
+        dst.push_back(sv.substr(start_content_pos, rpos - start_content_pos));
         current_search_pos = rpos + right_mark.length();
     }
-    return results;
+    return dst;
 }
 //------------------------------------------------------------------------------------------------
@@ -31,15 +31,67 @@
 #include <concepts>
 #include <type_traits>
 #include <utility>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <system_error>
+#include <exception>
+#include <charconv>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+#ifndef _WIN32
+  #include <sys/uio.h>
+#endif
 
 //------------------------------------------------------------------------
 // 1. Core Concepts
 //------------------------------------------------------------------------
 
-// Constrains C to be a range whose elements are convertible to std::string_view
-template <typename C>
-concept StringContainer_Join = std::ranges::input_range<C> &&
-    std::convertible_to<std::ranges::range_reference_t<C>, std::string_view>;
+// How strjoin writes an element that is not a string, straight into the output without allocating:
+// max_size bounds the text and format(out, v) writes it and returns its end. Integers and floats
+// use std::to_chars (floats in the shortest form that reads back the same). A type with
+//     static constexpr size_t max_chars;
+//     char* to_chars(char* out) const noexcept;
+// such as ip4 and ltuuid::uuid needs nothing more; others can specialize join_formatter.
+template <typename T>
+struct join_formatter {};
+
+template <std::integral T> requires (!std::same_as<T, bool>)
+struct join_formatter<T> {
+    static constexpr size_t max_size = std::numeric_limits<T>::digits10 + 2;
+    static char* format(char* out, T v) noexcept { return std::to_chars(out, out + max_size, v).ptr; }
+};
+
+template <>
+struct join_formatter<char> {
+    static constexpr size_t max_size = 1;
+    static char* format(char* out, char c) noexcept { *out = c; return out + 1; }
+};
+
+template <std::floating_point T>
+struct join_formatter<T> {
+    // sign, point, 'e', exponent sign and up to 5 exponent digits around the significant digits
+    static constexpr size_t max_size = std::numeric_limits<T>::max_digits10 + 10;
+    static char* format(char* out, T v) noexcept { return std::to_chars(out, out + max_size, v).ptr; }
+};
+
+template <typename T>
+    requires requires(const T& v, char* p) {
+        { T::max_chars } -> std::convertible_to<size_t>;
+        { v.to_chars(p) } -> std::same_as<char*>;
+    }
+struct join_formatter<T> {
+    static constexpr size_t max_size = T::max_chars;
+    static char* format(char* out, const T& v) noexcept { return v.to_chars(out); }
+};
+
+// Constrains C, with its elements projected by P, to yield strings or elements join_formatter can write
+template <typename C, typename P>
+concept ProjectedContainer_Join = std::ranges::input_range<const C> &&
+    std::regular_invocable<const P&, std::ranges::range_reference_t<const C>> &&
+    (std::convertible_to<std::invoke_result_t<const P&, std::ranges::range_reference_t<const C>>, std::string_view> ||
+     requires { join_formatter<std::remove_cvref_t<std::invoke_result_t<const P&, std::ranges::range_reference_t<const C>>>>::max_size; });
 
 // Constrains T to be a valid delimiter (char or string-like)
 template <typename T>
@@ -48,125 +100,323 @@ concept StrJoinDelimiter =
     std::convertible_to<T, std::string_view>;
 
 //------------------------------------------------------------------------
-// 2. Proxy for C++23 (Native Range Views)
+// 2. Common core of the proxies: the elements and the delimiter as pieces
 //------------------------------------------------------------------------
-template <std::ranges::range V>
-struct lazy_str_proxy {
-    V view;
+namespace impl {
 
-    // Scenario A: Zero-copy direct stream output
-    friend std::ostream& operator<<(std::ostream& os, const lazy_str_proxy& proxy) {
-        auto mutable_view = proxy.view;
-        char buf[1024];
-        size_t i = 0;
-        for (char c : mutable_view) {
-            buf[i++] = c;
-            if (i == sizeof(buf)) {
-                os.write(buf, static_cast<std::streamsize>(i));
-                i = 0;
-            }
+// Run work(0..n-1) with one thread per index, index 0 on the calling thread. If a thread cannot be
+// started its work is done here instead. An exception thrown by work(i), eg. std::bad_alloc on a
+// huge input, is caught on its thread; after all of them have joined, the one of the lowest i is
+// rethrown.
+template <typename F>
+void run_parallel(size_t n, F&& work)
+{
+    std::vector<std::exception_ptr> errors(n);
+    const auto guarded = [&](size_t i) noexcept {
+        try { work(i); }
+        catch (...) { errors[i] = std::current_exception(); }
+    };
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(n);
+        for (size_t i = 1; i < n; ++i) {
+            try { threads.emplace_back(guarded, i); }
+            catch (const std::system_error&) { guarded(i); }
         }
-        if (i > 0) os.write(buf, static_cast<std::streamsize>(i));
-        return os;
-    }
-
-    // Scenario B: Implicit conversion to std::string
-    operator std::string() const {
-        auto mutable_view = view;
-        std::string s;
-        for (char c : mutable_view) s.push_back(c);
-        return s;
-    }
+        guarded(0);
+    }   // the jthreads join here
+    for (const std::exception_ptr& e : errors)
+        if (e) std::rethrow_exception(e);
+}
 
-    // Scenario C: Support operator+ for concatenation
-    friend std::string operator+(const lazy_str_proxy& lhs, const std::string& rhs) { return static_cast<std::string>(lhs) + rhs; }
-    friend std::string operator+(const std::string& lhs, const lazy_str_proxy& rhs) { return lhs + static_cast<std::string>(rhs); }
-    friend std::string operator+(const lazy_str_proxy& lhs, const char* rhs) { return static_cast<std::string>(lhs) + rhs; }
-    friend std::string operator+(const char* lhs, const lazy_str_proxy& rhs) { return lhs + static_cast<std::string>(rhs); }
-};
+// Below this many elements per thread, a parallel join costs more than it saves
+inline constexpr size_t par_join_min_elems = 1 << 16;
 
-template <typename V>
-inline auto make_lazy_str_proxy(V&& view) {
-    return lazy_str_proxy<std::remove_cvref_t<V>>{std::forward<V>(view)};
+#ifndef _WIN32
+// writev until every byte is out, resuming after partial writes and EINTR
+inline bool writev_all(int fd, iovec* iov, int cnt) noexcept {
+    while (cnt > 0) {
+        const ssize_t n = ::writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        size_t left = static_cast<size_t>(n);
+        while (cnt > 0 && left >= iov->iov_len) { left -= iov->iov_len; ++iov; --cnt; }
+        if (cnt > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+    return true;
 }
+#endif
 
-//------------------------------------------------------------------------
-// 3. Proxy for C++20 Fallback (Forward Iteration on Containers)
-//------------------------------------------------------------------------
-template <typename C, typename D>
-struct lazy_container_proxy {
+template <typename C, typename D, typename P = std::identity>
+struct join_core {
     const C& container;
     D delim;
+    [[no_unique_address]] P proj;
 
-    friend std::ostream& operator<<(std::ostream& os, const lazy_container_proxy& proxy) {
-        char buf[1024];
-        size_t i = 0;
+    using elem_ref  = std::invoke_result_t<const P&, std::ranges::range_reference_t<const C>>;
+    using formatter = join_formatter<std::remove_cvref_t<elem_ref>>;
+    static constexpr bool formatted = !std::convertible_to<elem_ref, std::string_view>;
+    static constexpr size_t max_formatted = [] { if constexpr (formatted) return formatter::max_size; else return size_t{1}; }();
 
-        auto append_char = [&](char ch) {
-            buf[i++] = ch;
-            if (i == sizeof(buf)) { os.write(buf, static_cast<std::streamsize>(i)); i = 0; }
-        };
-        auto append_sv = [&](std::string_view sv) {
-            for (char ch : sv) append_char(ch);
-        };
+    std::string_view delim_sv() const noexcept {
+        if constexpr (std::same_as<D, char>) return {&delim, 1};
+        else return delim;
+    }
 
+    // Calls elem(x) for each projected element x and delim() between them
+    template <typename FE, typename FD>
+    void walk(FE&& elem, FD&& between) const {
         bool first = true;
-        for (const auto& item : proxy.container) {
-            if (!first) {
-                if constexpr (std::same_as<D, char>) append_char(proxy.delim);
-                else append_sv(proxy.delim);
-            }
+        for (const auto& item : container) {
+            if (!first) between();
             first = false;
-            append_sv(item);
+            elem(std::invoke(proj, item));
+        }
+    }
+
+    // Calls emit(std::string_view) for each element and delimiter in order; formatted elements
+    // are written to a stack buffer first
+    template <typename F>
+    void for_each_piece(F&& emit) const {
+        const std::string_view d = delim_sv();
+        char buf[max_formatted];
+        walk([&](auto&& x) {
+                if constexpr (formatted) emit(std::string_view(buf, static_cast<size_t>(formatter::format(buf, x) - buf)));
+                else emit(std::string_view(x));
+            },
+            [&] { emit(d); });
+    }
+
+    template <typename X>
+    static size_t piece_size(X&& x, char* buf) noexcept {
+        if constexpr (formatted) return static_cast<size_t>(formatter::format(buf, x) - buf);
+        else return std::string_view(x).size();
+    }
+    template <typename X>
+    static char* write_piece(char* p, X&& x) noexcept {
+        if constexpr (formatted) return formatter::format(p, x);
+        else {
+            const std::string_view sv(x);
+            if (!sv.empty()) std::memcpy(p, sv.data(), sv.size());
+            return p + sv.size();
         }
-        if (i > 0) os.write(buf, static_cast<std::streamsize>(i));
-        return os;
+    }
+
+    // Exact length of the joined string, by a pass over the element sizes (formatting them if need be)
+    size_t size() const {
+        size_t n = 0, count = 0;
+        if constexpr (formatted)
+            for_each_piece([&](std::string_view sv) { n += sv.size(); });
+        else {
+            for (const auto& item : container) { n += std::string_view(std::invoke(proj, item)).size(); ++count; }
+            if (count > 0) n += (count - 1) * delim_sv().size();
+        }
+        return n;
+    }
+
+    // Appends the joined string to s: one allocation at most, then one memcpy per piece. Formatted
+    // elements of a sized container are written in place into room for max_size chars each, so
+    // they are formatted once; the string may keep that spare capacity.
+    std::string& append_to(std::string& s) const {
+        if constexpr (formatted && std::ranges::sized_range<const C>) {
+            const std::string_view d = delim_sv();
+            const size_t n = std::ranges::size(container);
+            const size_t old = s.size();
+            s.resize(old + n * max_formatted + (n > 0 ? (n - 1) * d.size() : 0));
+            char* p = s.data() + old;
+            walk([&](auto&& x) { p = formatter::format(p, x); },
+                 [&] { std::memcpy(p, d.data(), d.size()); p += d.size(); });
+            s.resize(static_cast<size_t>(p - s.data()));
+        } else {
+            if constexpr (!formatted && std::ranges::forward_range<const C>) s.reserve(s.size() + size());
+            for_each_piece([&](std::string_view sv) { s.append(sv); });
+        }
+        return s;
     }
 
     operator std::string() const {
         std::string s;
-        bool first = true;
-        for (const auto& item : container) {
-            if (!first) {
-                if constexpr (std::same_as<D, char>) s.push_back(delim);
-                else s.append(delim);
-            }
-            first = false;
-            s.append(item);
+        append_to(s);
+        return s;
+    }
+
+    // append_to on nthreads threads (0 for all cores) for very large containers. The elements are
+    // cut into one share per thread; each thread sums the sizes of its share, a prefix sum of the
+    // sums gives the offset of each share in the result, which is allocated once, then each thread
+    // copies (or formats) its share at its offset. Containers without random access, or with fewer
+    // than impl::par_join_min_elems elements per thread, are joined serially.
+    std::string& append_to_par(std::string& s, unsigned nthreads = 0) const {
+        if constexpr (!std::ranges::random_access_range<const C> || !std::ranges::sized_range<const C>)
+            return append_to(s);
+        else {
+            const size_t n = std::ranges::size(container);
+            if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+            const size_t nshares = std::clamp<size_t>(n / par_join_min_elems, 1, nthreads);
+            if (nshares <= 1) return append_to(s);
+
+            const auto first = std::ranges::begin(container);
+            const auto at = [&](size_t i) -> decltype(auto) { return std::invoke(proj, first[static_cast<std::ranges::range_difference_t<const C>>(i)]); };
+            const auto lo = [&](size_t k) { return n / nshares * k; };
+            const auto hi = [&](size_t k) { return k + 1 == nshares ? n : lo(k + 1); };
+            const std::string_view d = delim_sv();
+
+            // off[k+1] is first the size of share k, a delimiter before each element but the first
+            std::vector<size_t> off(nshares + 1);
+            run_parallel(nshares, [&](size_t k) {
+                char buf[max_formatted];
+                size_t bytes = (hi(k) - lo(k)) * d.size();
+                for (size_t i = lo(k); i < hi(k); ++i) bytes += piece_size(at(i), buf);
+                off[k + 1] = bytes;
+            });
+            off[1] -= d.size();
+            for (size_t k = 1; k <= nshares; ++k) off[k] += off[k - 1];
+
+            const auto copy = [&](char* out) {
+                run_parallel(nshares, [&](size_t k) {
+                    char* p = out + off[k];
+                    for (size_t i = lo(k); i < hi(k); ++i) {
+                        if (i > 0) { std::memcpy(p, d.data(), d.size()); p += d.size(); }
+                        p = write_piece(p, at(i));
+                    }
+                });
+            };
+            const size_t old = s.size();
+#ifdef __cpp_lib_string_resize_and_overwrite
+            s.resize_and_overwrite(old + off[nshares], [&](char* buf, size_t len) { copy(buf + old); return len; });
+#else
+            s.resize(old + off[nshares]);
+            copy(s.data() + old);
+#endif
+            return s;
         }
+    }
+
+    std::string to_string_par(unsigned nthreads = 0) const {
+        std::string s;
+        append_to_par(s, nthreads);
         return s;
     }
 
-    friend std::string operator+(const lazy_container_proxy& lhs, const std::string& rhs) { return static_cast<std::string>(lhs) + rhs; }
-    friend std::string operator+(const std::string& lhs, const lazy_container_proxy& rhs) { return lhs + static_cast<std::string>(rhs); }
-    friend std::string operator+(const lazy_container_proxy& lhs, const char* rhs) { return static_cast<std::string>(lhs) + rhs; }
-    friend std::string operator+(const char* lhs, const lazy_container_proxy& rhs) { return lhs + static_cast<std::string>(rhs); }
+#ifndef _WIN32
+    // Writes the joined string to a file descriptor straight from the elements, gathering up to
+    // 256 pieces per writev. Elements the iovecs cannot point to until the writev (formatted ones,
+    // and strings that live only for their step of the walk: a projection returning by value, a
+    // view of prvalues) are copied to a 4 KiB scratch buffer first. Returns false with errno set
+    // on error.
+    bool write_to(int fd) const {
+        constexpr int max_iov = 256;
+        constexpr bool stable = !formatted && std::is_lvalue_reference_v<elem_ref> &&
+                                std::is_lvalue_reference_v<std::ranges::range_reference_t<const C>>;
+        iovec iov[max_iov];
+        int cnt = 0;
+        char scratch[stable ? 1 : 4096];
+        size_t used = 0;
+        bool ok = true;
+
+        const auto flush = [&] {
+            if (ok) ok = writev_all(fd, iov, cnt);
+            cnt = 0;
+            used = 0;
+        };
+        const auto add = [&](std::string_view sv) {
+            if (!ok || sv.empty()) return;
+            iov[cnt++] = {const_cast<char*>(sv.data()), sv.size()};
+            if (cnt == max_iov) flush();
+        };
+        const auto add_copy = [&](std::string_view sv) {
+            if (used + sv.size() > sizeof(scratch)) flush();
+            if (sv.size() > sizeof(scratch)) { add(sv); flush(); return; }  // out while sv lives
+            char* b = scratch + used;
+            if (!sv.empty()) std::memcpy(b, sv.data(), sv.size());
+            used += sv.size();
+            add({b, sv.size()});
+        };
+        const std::string_view d = delim_sv();
+        walk([&](auto&& x) {
+                if constexpr (formatted) {
+                    if (used + max_formatted > sizeof(scratch)) flush();
+                    char* b = scratch + used;
+                    const size_t len = static_cast<size_t>(formatter::format(b, x) - b);
+                    used += len;
+                    add({b, len});
+                }
+                else if constexpr (stable) add(std::string_view(x));
+                else add_copy(std::string_view(x));
+            },
+            [&] { add(d); });
+        return ok && writev_all(fd, iov, cnt);
+    }
+#endif
+
+    // Zero-copy stream output: each piece goes to the stream buffer as it is
+    friend std::ostream& operator<<(std::ostream& os, const join_core& j) {
+        j.for_each_piece([&](std::string_view sv) { os.write(sv.data(), static_cast<std::streamsize>(sv.size())); });
+        return os;
+    }
+
+    friend std::string operator+(const join_core& lhs, const std::string& rhs) { std::string s; if constexpr (!formatted) s.reserve(lhs.size() + rhs.size()); return lhs.append_to(s).append(rhs); }
+    friend std::string operator+(const std::string& lhs, const join_core& rhs) { std::string s(lhs); return rhs.append_to(s); }
+    friend std::string operator+(const join_core& lhs, const char* rhs) { return lhs + std::string(rhs); }
+    friend std::string operator+(const char* lhs, const join_core& rhs) { return std::string(lhs) + rhs; }
+};
+
+} // namespace impl
+
+//------------------------------------------------------------------------
+// 3. Proxies: std::string conversion, size(), append_to(), write_to(fd), operator<< and
+//    operator+ come from impl::join_core
+//------------------------------------------------------------------------
+
+// C++23 (Native Range Views): view is the std::views::join_with of the container, for use as a range
+template <std::ranges::range V, typename C, typename D>
+struct lazy_str_proxy : impl::join_core<C, D> {
+    V view;
 };
 
+template <typename C, typename D, typename V>
+inline auto make_lazy_str_proxy(const C& container, D delim, V&& view) {
+    return lazy_str_proxy<std::remove_cvref_t<V>, C, D>{{container, delim, {}}, std::forward<V>(view)};
+}
+
+// C++20 Fallback (Forward Iteration on Containers), and elements projected or formatted
+template <typename C, typename D, typename P = std::identity>
+struct lazy_container_proxy : impl::join_core<C, D, P> {};
+
 //------------------------------------------------------------------------
 // 4. strjoin: Join any string container using a delimiter lazily
 //------------------------------------------------------------------------
+// proj, applied to each element with std::invoke, may pick a string member or turn the element
+// into something join_formatter can write, eg.
+//     std::vector<int> ids{3, 5, 8};          strjoin(ids, ',')               -> "3,5,8"
+//     std::set<ip4> hosts;                    std::cout << strjoin(hosts, ' ');
+//     std::vector<user> users;                strjoin(users, ", ", &user::name)
 #ifdef __cpp_lib_ranges_join_with
 
-template <StringContainer_Join C, StrJoinDelimiter T = std::string_view>
-inline auto strjoin(const C& container, const T& delimiter = " ") {
-    if constexpr (std::same_as<std::remove_cvref_t<T>, char>) {
-        return make_lazy_str_proxy(container | std::views::join_with(delimiter));
-    } else {
-        return make_lazy_str_proxy(container | std::views::join_with(std::string_view{delimiter}));
-    }
+template <typename C, StrJoinDelimiter T = std::string_view, typename P = std::identity>
+    requires ProjectedContainer_Join<C, P>
+inline auto strjoin(const C& container, const T& delimiter = " ", P proj = {}) {
+    using D = std::conditional_t<std::same_as<std::remove_cvref_t<T>, char>, char, std::string_view>;
+    const D d{delimiter};
+    // Elements that are not ranges themselves, eg. const char* or numbers, cannot be join_with'ed
+    if constexpr (std::same_as<P, std::identity> && requires { container | std::views::join_with(d); })
+        return make_lazy_str_proxy(container, d, container | std::views::join_with(d));
+    else
+        return lazy_container_proxy<C, D, P>{{container, d, std::move(proj)}};
 }
 
 #else
 
 // C++20 Fallback seamlessly handles unordered_set, multiset, etc.
-template <StringContainer_Join C, StrJoinDelimiter T = std::string_view>
-inline auto strjoin(const C& container, const T& delimiter = " ") {
-    if constexpr (std::same_as<std::remove_cvref_t<T>, char>) {
-        return lazy_container_proxy<C, char>{container, delimiter};
-    } else {
-        return lazy_container_proxy<C, std::string_view>{container, std::string_view{delimiter}};
-    }
+template <typename C, StrJoinDelimiter T = std::string_view, typename P = std::identity>
+    requires ProjectedContainer_Join<C, P>
+inline auto strjoin(const C& container, const T& delimiter = " ", P proj = {}) {
+    using D = std::conditional_t<std::same_as<std::remove_cvref_t<T>, char>, char, std::string_view>;
+    return lazy_container_proxy<C, D, P>{{container, D{delimiter}, std::move(proj)}};
 }
 
 #endif
@@ -0,0 +1,140 @@
+//  String interning pool: repeated tokens are stored once and named by 32-bit symbol IDs.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include "strpool.hpp"
+
+//------------------------------------------------------------------------------------------------
+uint32_t strpool::hash(std::string_view sv) noexcept
+{
+    const uint64_t h = std::hash<std::string_view>{}(sv);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+//------------------------------------------------------------------------------------------------
+// Slot holding sv, or the empty slot where it would go. slots_ is never full (load <= 1/2).
+size_t strpool::slot_of(std::string_view sv, uint32_t h) const noexcept
+{
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = h & mask; ; i = (i + 1) & mask) {
+        const uint32_t s = slots_[i];
+        if (s == 0) return i;
+        if (hashes_[s-1] == h && views_[s-1] == sv) return i;
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+const char* strpool::store(std::string_view sv)
+{
+    const size_t need = sv.size() + 1;
+    if (need > left_) {
+        // A string longer than a quarter block gets a block of its own, so the current block
+        // keeps its free space for the short ones
+        if (need > block_size_ / 4) {
+            blocks_.push_back({std::make_unique<char[]>(need), need});
+            bytes_ += need;
+            char* p = blocks_.back().data.get();
+            std::memcpy(p, sv.data(), sv.size());
+            p[sv.size()] = '\0';
+            return p;
+        }
+        blocks_.push_back({std::make_unique<char[]>(block_size_), block_size_});
+        bytes_ += block_size_;
+        cur_  = blocks_.back().data.get();
+        left_ = block_size_;
+    }
+
+    char* p = cur_;
+    std::memcpy(p, sv.data(), sv.size());
+    p[sv.size()] = '\0';
+    cur_  += need;
+    left_ -= need;
+    return p;
+}
+
+//------------------------------------------------------------------------------------------------
+void strpool::rehash(size_t nslots)
+{
+    slots_.assign(nslots, 0);
+    const size_t mask = nslots - 1;
+    for (size_t id = 0; id < hashes_.size(); ++id) {
+        size_t i = hashes_[id] & mask;
+        while (slots_[i] != 0) i = (i + 1) & mask;
+        slots_[i] = static_cast<uint32_t>(id + 1);
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+void strpool::reserve(size_t n)
+{
+    views_.reserve(n);
+    hashes_.reserve(n);
+    if (n * 2 > slots_.size()) rehash(std::bit_ceil(std::max<size_t>(n * 2, 16)));
+}
+
+//------------------------------------------------------------------------------------------------
+TSymId strpool::find(std::string_view sv) const noexcept
+{
+    if (slots_.empty()) return npos;
+    const uint32_t s = slots_[slot_of(sv, hash(sv))];
+    return s == 0 ? npos : s - 1;
+}
+
+//------------------------------------------------------------------------------------------------
+TSymId strpool::intern(std::string_view sv)
+{
+    const uint32_t h = hash(sv);
+    if (!slots_.empty()) {
+        const size_t i = slot_of(sv, h);
+        if (slots_[i] != 0) return slots_[i] - 1;
+    }
+
+    if (views_.size() >= npos - 1) throw std::length_error("strpool: too many symbols");
+    if ((views_.size() + 1) * 2 > slots_.size()) rehash(std::max<size_t>(slots_.size() * 2, 16));
+
+    const TSymId id = static_cast<TSymId>(views_.size());
+    views_.emplace_back(store(sv), sv.size());
+    hashes_.push_back(h);
+    slots_[slot_of(sv, h)] = id + 1;
+    return id;
+}
+
+//------------------------------------------------------------------------------------------------
+void strpool::clear() noexcept
+{
+    blocks_.clear();
+    cur_  = nullptr;
+    left_ = 0;
+    views_.clear();
+    hashes_.clear();
+    slots_.clear();
+    bytes_ = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+TSymId strpool_mt::intern(std::string_view sv)
+{
+    {
+        std::shared_lock lk(mtx_);
+        if (const TSymId id = pool_.find(sv); id != npos) return id;
+    }
+    std::unique_lock lk(mtx_);
+    return pool_.intern(sv);    // looks again, another thread may have added sv meanwhile
+}
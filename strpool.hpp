@@ -0,0 +1,129 @@
+//  String interning pool: repeated tokens are stored once and named by 32-bit symbol IDs.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "strext.hpp"
+
+// Eg. counting the hosts of a log without a std::string per line:
+//     strpool pool;
+//     TSymVec ids;
+//     for (auto line : lines) { splitsym(ids, line, " ", pool); ++hits[ids[0]]; }
+//     for (auto [id, n] : hits) std::cout << pool[id] << ' ' << n << '\n';
+
+using TSymId  = uint32_t;
+using TSymVec = std::vector<TSymId>;
+
+//------------------------------------------------------------------------------------------------
+// IDs are dense, 0..size()-1 in order of first appearance. The interned bytes live in an arena of
+// fixed blocks that is never moved, so a view returned by the pool stays valid (and NUL terminated)
+// until clear() or the pool is destroyed, however many strings are added later.
+class strpool {
+private:
+    struct block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<block> blocks_;
+    char*  cur_{};
+    size_t left_{};
+    size_t block_size_;
+
+    std::vector<std::string_view> views_;   // indexed by ID
+    std::vector<uint32_t> hashes_;          // indexed by ID, kept for rehashing
+    std::vector<uint32_t> slots_;           // open addressing: ID+1, 0 for an empty slot
+    size_t bytes_{};
+
+    static uint32_t hash(std::string_view sv) noexcept;
+    size_t slot_of(std::string_view sv, uint32_t h) const noexcept;
+    const char* store(std::string_view sv);
+    void rehash(size_t nslots);
+
+public:
+    static constexpr TSymId npos = UINT32_MAX;
+
+    explicit strpool(size_t block_size=64*1024): block_size_(block_size) {}
+
+    // ID of sv, adding it on first sight. Throws std::length_error when IDs run out.
+    TSymId intern(std::string_view sv);
+    // ID of sv, or npos if it was never interned
+    TSymId find(std::string_view sv) const noexcept;
+
+    std::string_view view(TSymId id) const noexcept { return views_[id]; }
+    std::string_view operator[](TSymId id) const noexcept { return views_[id]; }
+
+    size_t size()  const noexcept { return views_.size(); }
+    bool   empty() const noexcept { return views_.empty(); }
+    size_t bytes() const noexcept { return bytes_; }  // arena bytes allocated
+    void   reserve(size_t n);
+    void   clear() noexcept;
+};
+
+//------------------------------------------------------------------------------------------------
+// Thread-safe strpool. Lookups of strings already present, the common case for repetitive data,
+// take a shared lock only.
+class strpool_mt {
+private:
+    strpool pool_;
+    mutable std::shared_mutex mtx_;
+
+public:
+    static constexpr TSymId npos = strpool::npos;
+
+    explicit strpool_mt(size_t block_size=64*1024): pool_(block_size) {}
+
+    TSymId intern(std::string_view sv);
+    TSymId find(std::string_view sv) const noexcept { std::shared_lock lk(mtx_); return pool_.find(sv); }
+
+    std::string_view view(TSymId id) const noexcept { std::shared_lock lk(mtx_); return pool_.view(id); }
+    std::string_view operator[](TSymId id) const noexcept { return view(id); }
+
+    size_t size()  const noexcept { std::shared_lock lk(mtx_); return pool_.size(); }
+    bool   empty() const noexcept { std::shared_lock lk(mtx_); return pool_.empty(); }
+    size_t bytes() const noexcept { std::shared_lock lk(mtx_); return pool_.bytes(); }
+    void   reserve(size_t n) { std::unique_lock lk(mtx_); pool_.reserve(n); }
+    void   clear() noexcept  { std::unique_lock lk(mtx_); pool_.clear(); }
+};
+
+//------------------------------------------------------------------------------------------------
+// Same tokens as splits(src, delimiters, opt), interned into pool; dst receives their IDs.
+// Throws what pool.intern() throws (std::length_error when IDs run out), leaving in dst the IDs
+// of the tokens before.
+template <typename T, typename Pool>
+inline TSymVec& splitsym(TSymVec& dst, std::string_view src, T delimiters, Pool& pool, SplitOptions opt=0)
+{
+    dst.clear();
+    for (const std::string_view sv : split_view(src, delimiters, opt)) dst.push_back(pool.intern(sv));
+    return dst;
+}
+
+template <typename T, typename Pool>
+inline TSymVec splitsym(std::string_view src, T delimiters, Pool& pool, SplitOptions opt=0)
+{
+    TSymVec dst;
+    splitsym(dst, src, delimiters, pool, opt);
+    return dst;
+}
@@ -0,0 +1,824 @@
+//  Vectorized byte-class kernels (scanning, trimming, case mapping) used by strext.
+//
+//  Header-only file.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <string_view>
+#include <utility>
+#include <bit>      // Since C++ 20
+#include <type_traits>
+
+// The kernels are selected at compile time, build with -mavx2 (or -march=native)
+// to get the 32-byte paths. x86-64 always has SSE2; other targets use the scalar
+// fallback.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__PCLMUL__) && !defined(__AVX2__)
+#include <wmmintrin.h>
+#endif
+
+namespace strscan {
+
+inline constexpr size_t npos  = std::string_view::npos;
+inline constexpr size_t block = 64;     // bytes classified per step, one bit each
+
+//------------------------------------------------------------------------
+// 256-bit byte membership set.
+// Besides the bitmap it keeps:
+//   . the member list while it is short, so SSE2 can classify by compare-and-or;
+//   . two 16-byte nibble tables for the SSSE3/AVX2 shuffle lookup of any set:
+//     lo_tbl[c & 15] has bit (c >> 4) set for members below 0x80, hi_tbl[] for
+//     the upper half.
+class charset {
+public:
+    static constexpr size_t max_cmp = 8;
+
+private:
+    uint64_t bits_[4]{};
+    uint8_t  lo_tbl_[16]{};
+    uint8_t  hi_tbl_[16]{};
+    char     members_[max_cmp]{};
+    uint16_t count_{};
+
+public:
+    constexpr charset() noexcept = default;
+    constexpr charset(char c) noexcept { set(c); }
+    constexpr charset(std::string_view chars) noexcept { for (const char c : chars) set(c); }
+
+    constexpr charset& set(char ch) noexcept {
+        if (test(ch)) return *this;
+
+        const auto c = static_cast<unsigned char>(ch);
+        bits_[c >> 6] |= uint64_t{1} << (c & 63);
+        if (c < 0x80) lo_tbl_[c & 15] |= static_cast<uint8_t>(1u << (c >> 4));
+        else          hi_tbl_[c & 15] |= static_cast<uint8_t>(1u << ((c >> 4) - 8));
+        if (count_ < max_cmp) members_[count_] = ch;
+        ++count_;
+        return *this;
+    }
+
+    constexpr bool test(char ch) const noexcept {
+        const auto c = static_cast<unsigned char>(ch);
+        return (bits_[c >> 6] >> (c & 63)) & 1;
+    }
+
+    constexpr size_t size()  const noexcept { return count_; }
+    constexpr bool   empty() const noexcept { return count_ == 0; }
+
+    // Only the first min(size(), max_cmp) members are recorded
+    constexpr const char*    members()  const noexcept { return members_; }
+    constexpr const uint8_t* lo_table() const noexcept { return lo_tbl_; }
+    constexpr const uint8_t* hi_table() const noexcept { return hi_tbl_; }
+};
+
+//------------------------------------------------------------------------
+namespace impl {
+
+inline uint64_t classify_scalar(const char* p, size_t n, const charset& cs) noexcept {
+    uint64_t mask{};
+    for (size_t i = 0; i < n; ++i)
+        mask |= static_cast<uint64_t>(cs.test(p[i])) << i;
+    return mask;
+}
+
+#if defined(__AVX2__)
+inline uint32_t classify32(const char* p, const charset& cs) noexcept {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+    if (cs.size() <= charset::max_cmp) {
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t i = 0; i < cs.size(); ++i)
+            acc = _mm256_or_si256(acc, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(cs.members()[i])));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(acc));
+    }
+
+    const __m256i lo_tbl = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cs.lo_table())));
+    const __m256i hi_tbl = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cs.hi_table())));
+    const __m256i lo_bit = _mm256_setr_epi8(1,2,4,8,16,32,64,-128,0,0,0,0,0,0,0,0, 1,2,4,8,16,32,64,-128,0,0,0,0,0,0,0,0);
+    const __m256i hi_bit = _mm256_setr_epi8(0,0,0,0,0,0,0,0,1,2,4,8,16,32,64,-128, 0,0,0,0,0,0,0,0,1,2,4,8,16,32,64,-128);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    const __m256i lo = _mm256_and_si256(v, nibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    const __m256i r  = _mm256_or_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(lo_tbl, lo), _mm256_shuffle_epi8(lo_bit, hi)),
+        _mm256_and_si256(_mm256_shuffle_epi8(hi_tbl, lo), _mm256_shuffle_epi8(hi_bit, hi)));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(r, _mm256_setzero_si256())));
+}
+#elif defined(__SSE2__)
+inline uint32_t classify16(const char* p, const charset& cs) noexcept {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+    if (cs.size() <= charset::max_cmp) {
+        __m128i acc = _mm_setzero_si128();
+        for (size_t i = 0; i < cs.size(); ++i)
+            acc = _mm_or_si128(acc, _mm_cmpeq_epi8(v, _mm_set1_epi8(cs.members()[i])));
+        return static_cast<uint32_t>(_mm_movemask_epi8(acc));
+    }
+
+#if defined(__SSSE3__)
+    const __m128i lo_tbl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cs.lo_table()));
+    const __m128i hi_tbl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cs.hi_table()));
+    const __m128i lo_bit = _mm_setr_epi8(1,2,4,8,16,32,64,-128,0,0,0,0,0,0,0,0);
+    const __m128i hi_bit = _mm_setr_epi8(0,0,0,0,0,0,0,0,1,2,4,8,16,32,64,-128);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    const __m128i lo = _mm_and_si128(v, nibble);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+    const __m128i r  = _mm_or_si128(
+        _mm_and_si128(_mm_shuffle_epi8(lo_tbl, lo), _mm_shuffle_epi8(lo_bit, hi)),
+        _mm_and_si128(_mm_shuffle_epi8(hi_tbl, lo), _mm_shuffle_epi8(hi_bit, hi)));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(r, _mm_setzero_si128()))) & 0xFFFFu;
+#else
+    return static_cast<uint32_t>(classify_scalar(p, 16, cs));
+#endif
+}
+#endif
+
+// One bit per byte of p[0..63], set if the byte is a member of cs
+inline uint64_t classify64(const char* p, const charset& cs) noexcept {
+#if defined(__AVX2__)
+    return uint64_t{classify32(p, cs)} | (uint64_t{classify32(p + 32, cs)} << 32);
+#elif defined(__SSE2__)
+    return  uint64_t{classify16(p,      cs)}        | (uint64_t{classify16(p + 16, cs)} << 16)
+         | (uint64_t{classify16(p + 32, cs)} << 32) | (uint64_t{classify16(p + 48, cs)} << 48);
+#else
+    return classify_scalar(p, block, cs);
+#endif
+}
+
+} // namespace impl
+
+//------------------------------------------------------------------------
+// Classifiers map 64 bytes to a member bitmask for basic_cursor.
+// runtime_classifier works on any charset; fixed_classifier takes a constexpr one and picks the
+// kernel at compile time: nothing for an empty set, compares against the members as immediate
+// constants for a short set, the nibble-table lookup otherwise.
+struct runtime_classifier {
+    const charset* cs{};
+    uint64_t operator()(const char* p) const noexcept { return impl::classify64(p, *cs); }
+};
+
+namespace impl {
+
+template <const charset& CS, size_t... I>
+inline uint64_t classify64_fixed(const char* p, std::index_sequence<I...>) noexcept {
+#if defined(__AVX2__)
+    uint64_t mask{};
+    for (size_t half = 0; half < 2; ++half) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + half * 32));
+        __m256i acc = _mm256_setzero_si256();
+        ((acc = _mm256_or_si256(acc, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(CS.members()[I])))), ...);
+        mask |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(acc))} << (half * 32);
+    }
+    return mask;
+#elif defined(__SSE2__)
+    uint64_t mask{};
+    for (size_t quarter = 0; quarter < 4; ++quarter) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + quarter * 16));
+        __m128i acc = _mm_setzero_si128();
+        ((acc = _mm_or_si128(acc, _mm_cmpeq_epi8(v, _mm_set1_epi8(CS.members()[I])))), ...);
+        mask |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(acc))} << (quarter * 16);
+    }
+    return mask;
+#else
+    uint64_t mask{};
+    for (size_t i = 0; i < block; ++i)
+        mask |= static_cast<uint64_t>(((p[i] == CS.members()[I]) || ...)) << i;
+    return mask;
+#endif
+}
+
+} // namespace impl
+
+template <const charset& CS>
+struct fixed_classifier {
+    uint64_t operator()(const char* p) const noexcept {
+        if constexpr (CS.empty())
+            return 0;
+        else if constexpr (CS.size() <= charset::max_cmp)
+            return impl::classify64_fixed<CS>(p, std::make_index_sequence<CS.size()>{});
+        else
+            return impl::classify64(p, CS);
+    }
+};
+
+//------------------------------------------------------------------------
+// Forward scanner over the member bytes of a string_view.
+// Classifies 64 bytes at a time into a bitmask, then hands out the positions
+// one by one from the mask, so the per-delimiter cost is a count-trailing-zeros.
+template <typename Classifier>
+class basic_cursor {
+private:
+    const char* data_{};
+    size_t      size_{};
+    Classifier  classify_{};
+    size_t      block_{};       // offset of the block held in mask_
+    uint64_t    mask_{};        // members not yet returned in the current block
+
+    void load() noexcept {
+        const size_t rest {size_ - block_};
+        if (rest >= block) {
+            mask_ = classify_(data_ + block_);
+        } else {    // never read past the end
+            char buf[block]{};
+            std::memcpy(buf, data_ + block_, rest);
+            mask_ = classify_(buf) & ((uint64_t{1} << rest) - 1);
+        }
+    }
+
+public:
+    constexpr basic_cursor() noexcept = default;
+    basic_cursor(std::string_view sv, Classifier classify, size_t pos = 0) noexcept
+        : data_(sv.data()), size_(sv.size()), classify_(classify) { seek(pos); }
+
+    // Restart scanning at byte pos
+    void seek(size_t pos) noexcept {
+        block_ = pos - pos % block;
+        mask_  = 0;
+        if (block_ < size_) {
+            load();
+            mask_ &= ~uint64_t{0} << (pos % block);
+        }
+    }
+
+    // Position of the next member byte, or npos when there is none left
+    size_t next() noexcept {
+        while (!mask_) {
+            if (block_ + block >= size_) return npos;
+            block_ += block;
+            load();
+        }
+        const size_t pos {block_ + static_cast<size_t>(std::countr_zero(mask_))};
+        mask_ &= mask_ - 1;
+        return pos;
+    }
+};
+
+// Scanner over a runtime charset, which must outlive the cursor
+class cursor : public basic_cursor<runtime_classifier> {
+public:
+    constexpr cursor() noexcept = default;
+    cursor(std::string_view sv, const charset& cs, size_t pos = 0) noexcept
+        : basic_cursor(sv, runtime_classifier{&cs}, pos) {}
+};
+
+// Scanner over a constexpr charset with static storage, eg. fixed_cursor<delims<" ,">::set>
+template <const charset& CS>
+class fixed_cursor : public basic_cursor<fixed_classifier<CS>> {
+public:
+    constexpr fixed_cursor() noexcept = default;
+    fixed_cursor(std::string_view sv, size_t pos = 0) noexcept
+        : basic_cursor<fixed_classifier<CS>>(sv, fixed_classifier<CS>{}, pos) {}
+};
+
+//------------------------------------------------------------------------
+// White space of the "C" locale: " \t\n\v\f\r", as a 256-entry table
+inline constexpr auto space_table = [] {
+    std::array<bool, 256> tbl{};
+    for (const unsigned char c : std::string_view{" \t\n\v\f\r"}) tbl[c] = true;
+    return tbl;
+}();
+
+constexpr bool is_space(char c) noexcept { return space_table[static_cast<unsigned char>(c)]; }
+
+namespace impl {
+
+#if defined(__SSE2__)
+// One bit per byte of p[0..15], set for white space: ' ' or '\t'..'\r'
+inline uint32_t space_mask16(const char* p) noexcept {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+        _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('\r' + 1), v)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(m));
+}
+#endif
+
+} // namespace impl
+
+// Number of leading white-space bytes of p[0..n)
+inline size_t space_prefix(const char* p, size_t n) noexcept {
+    size_t i{};
+    if (n == 0 || !is_space(p[0])) return 0;    // most strings have nothing to trim
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+        if (const uint32_t m {impl::space_mask16(p + i) ^ 0xFFFFu}) return i + std::countr_zero(m);
+#endif
+    while (i < n && is_space(p[i])) ++i;
+    return i;
+}
+
+// Length of p[0..n) without its trailing white space
+inline size_t space_suffix_trimmed(const char* p, size_t n) noexcept {
+    if (n == 0 || !is_space(p[n-1])) return n;
+#if defined(__SSE2__)
+    for (; n >= 16; n -= 16)
+        if (const uint32_t m {impl::space_mask16(p + n - 16) ^ 0xFFFFu}) return n - 16 + 32 - std::countl_zero(m);
+#endif
+    while (n > 0 && is_space(p[n-1])) --n;
+    return n;
+}
+
+//------------------------------------------------------------------------
+// Leading and trailing runs of a constexpr charset, eg. the quotes of delims<"\"' ">::set. Whole
+// 64-byte blocks go through fixed_classifier; the first byte and the tail are tested by one
+// compare for a single byte, by compares against the members as constants for a short set, and
+// by the bitmap otherwise.
+namespace impl {
+
+template <const charset& CS>
+constexpr bool fixed_test(char c) noexcept {
+    if constexpr (CS.size() == 1)
+        return c == CS.members()[0];
+    else if constexpr (CS.size() <= charset::max_cmp)
+        return [c]<size_t... I>(std::index_sequence<I...>) { return ((c == CS.members()[I]) || ...); }
+            (std::make_index_sequence<CS.size()>{});
+    else
+        return CS.test(c);
+}
+
+} // namespace impl
+
+// Number of leading bytes of p[0..n) in CS
+template <const charset& CS>
+inline size_t member_prefix(const char* p, size_t n) noexcept {
+    if constexpr (CS.empty()) return 0;
+    else {
+        if (n == 0 || !impl::fixed_test<CS>(p[0])) return 0;    // most strings have nothing to trim
+        size_t i{};
+        for (; i + block <= n; i += block)
+            if (const uint64_t m {~fixed_classifier<CS>{}(p + i)}) return i + static_cast<size_t>(std::countr_zero(m));
+        while (i < n && impl::fixed_test<CS>(p[i])) ++i;
+        return i;
+    }
+}
+
+// Length of p[0..n) without its trailing bytes in CS
+template <const charset& CS>
+inline size_t member_suffix_trimmed(const char* p, size_t n) noexcept {
+    if constexpr (CS.empty()) return n;
+    else {
+        if (n == 0 || !impl::fixed_test<CS>(p[n-1])) return n;
+        for (; n >= block; n -= block)
+            if (const uint64_t m {~fixed_classifier<CS>{}(p + n - block)}) return n - static_cast<size_t>(std::countl_zero(m));
+        while (n > 0 && impl::fixed_test<CS>(p[n-1])) --n;
+        return n;
+    }
+}
+
+//------------------------------------------------------------------------
+// ASCII-only case mapping, independent of the C locale. Bytes >= 0x80 are left untouched.
+constexpr char lower(char c) noexcept { return static_cast<unsigned char>(c - 'A') < 26 ? static_cast<char>(c | 0x20) : c; }
+constexpr char upper(char c) noexcept { return static_cast<unsigned char>(c - 'a') < 26 ? static_cast<char>(c & ~0x20) : c; }
+
+namespace impl {
+
+// Map n bytes from src to dst (which may be src) to lower or upper case
+template <bool Upper>
+inline void map_case(const char* src, char* dst, size_t n) noexcept {
+    size_t i{};
+    // Signed compares work for the range test, bytes >= 0x80 are negative and never match
+    constexpr char first {Upper? 'a' : 'A'};
+#if defined(__AVX2__)
+    const __m256i lo  = _mm256_set1_epi8(first - 1);
+    const __m256i hi  = _mm256_set1_epi8(first + 26);
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i m = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, _mm256_and_si256(m, bit)));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i lo16  = _mm_set1_epi8(first - 1);
+    const __m128i hi16  = _mm_set1_epi8(first + 26);
+    const __m128i bit16 = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i m = _mm_and_si128(_mm_cmpgt_epi8(v, lo16), _mm_cmpgt_epi8(hi16, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, _mm_and_si128(m, bit16)));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = Upper? upper(src[i]) : lower(src[i]);
+}
+
+} // namespace impl
+
+inline void to_lower(const char* src, char* dst, size_t n) noexcept { impl::map_case<false>(src, dst, n); }
+inline void to_upper(const char* src, char* dst, size_t n) noexcept { impl::map_case<true >(src, dst, n); }
+
+// ASCII case-insensitive comparison of a[0..n) and b[0..n)
+inline bool iequal(const char* a, const char* b, size_t n) noexcept {
+    size_t i{};
+#if defined(__SSE2__)
+    const __m128i lo  = _mm_set1_epi8('A' - 1);
+    const __m128i hi  = _mm_set1_epi8('Z' + 1);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    const auto fold = [&](__m128i v) {
+        return _mm_or_si128(v, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmpgt_epi8(hi, v)), bit));
+    };
+    for (; i + 16 <= n; i += 16) {
+        const __m128i va = fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        const __m128i vb = fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) return false;
+    }
+#endif
+    for (; i < n; ++i) if (lower(a[i]) != lower(b[i])) return false;
+    return true;
+}
+
+//------------------------------------------------------------------------
+// Bitmasks of the bytes of p[0..63] equal to a, b and c, with one load of each vector for all three
+struct eq3_masks { uint64_t a, b, c; };
+
+inline eq3_masks eq3_mask64(const char* p, char a, char b, char c) noexcept {
+    eq3_masks m{};
+#if defined(__AVX2__)
+    const __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b), vc = _mm256_set1_epi8(c);
+    for (size_t i = 0; i < block; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        m.a |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, va)))} << i;
+        m.b |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vb)))} << i;
+        m.c |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc)))} << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+    for (size_t i = 0; i < block; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        m.a |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, va)))} << i;
+        m.b |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, vb)))} << i;
+        m.c |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, vc)))} << i;
+    }
+#else
+    for (size_t i = 0; i < block; ++i) {
+        m.a |= static_cast<uint64_t>(p[i] == a) << i;
+        m.b |= static_cast<uint64_t>(p[i] == b) << i;
+        m.c |= static_cast<uint64_t>(p[i] == c) << i;
+    }
+#endif
+    return m;
+}
+
+// Bit i of the result is the XOR of bits 0..i of m. Applied to a quote mask it marks the bytes
+// inside quotes (opening quote included, closing quote excluded). A carry-less multiply by all
+// ones computes it in one instruction when PCLMULQDQ is available.
+inline uint64_t prefix_xor(uint64_t m) noexcept {
+#if defined(__PCLMUL__)
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(
+        _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(m)), _mm_set1_epi8(-1), 0)));
+#else
+    m ^= m << 1;
+    m ^= m << 2;
+    m ^= m << 4;
+    m ^= m << 8;
+    m ^= m << 16;
+    m ^= m << 32;
+    return m;
+#endif
+}
+
+//------------------------------------------------------------------------
+// UTF-8. A code point starts at each byte that is not a continuation byte 10xxxxxx, ie. at each
+// byte above -65 as a signed char.
+constexpr bool is_utf8_lead(char c) noexcept { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; }
+
+namespace impl {
+
+// Bitmask of the code point starts in p[0..63]
+inline uint64_t utf8_lead_mask64(const char* p) noexcept {
+    uint64_t m{};
+#if defined(__AVX2__)
+    const __m256i cont_max = _mm256_set1_epi8(-65);
+    for (size_t i = 0; i < block; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        m |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, cont_max)))} << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i cont_max = _mm_set1_epi8(-65);
+    for (size_t i = 0; i < block; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        m |= uint64_t{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, cont_max)))} << i;
+    }
+#else
+    for (size_t i = 0; i < block; ++i) m |= static_cast<uint64_t>(is_utf8_lead(p[i])) << i;
+#endif
+    return m;
+}
+
+// Position of the k-th (from 0) set bit of m, which has more than k
+inline size_t select_bit(uint64_t m, size_t k) noexcept {
+#if defined(__AVX2__) && defined(__BMI2__)
+    return static_cast<size_t>(std::countr_zero(_pdep_u64(uint64_t{1} << k, m)));
+#else
+    for (; k > 0; --k) m &= m - 1;
+    return static_cast<size_t>(std::countr_zero(m));
+#endif
+}
+
+// Adds the code point starts of the whole vectors of p[0..n) to count and returns the bytes done.
+// Each vector's lead bytes are added to per-byte counters, which are summed after 255 steps at most.
+inline size_t utf8_count_vectors(const char* p, size_t n, size_t& count) noexcept {
+    size_t i{};
+#if defined(__AVX2__)
+    const __m256i cont_max = _mm256_set1_epi8(-65);
+    const size_t whole = n - n % 32;
+    while (i < whole) {
+        const size_t stop = whole - i > 255 * 32 ? i + 255 * 32 : whole;
+        __m256i acc = _mm256_setzero_si256();
+        for (; i < stop; i += 32)
+            acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), cont_max));
+        const __m256i s = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+        count += static_cast<size_t>(_mm256_extract_epi64(s, 0) + _mm256_extract_epi64(s, 1) + _mm256_extract_epi64(s, 2) + _mm256_extract_epi64(s, 3));
+    }
+#elif defined(__SSE2__)
+    const __m128i cont_max = _mm_set1_epi8(-65);
+    const size_t whole = n - n % 16;
+    while (i < whole) {
+        const size_t stop = whole - i > 255 * 16 ? i + 255 * 16 : whole;
+        __m128i acc = _mm_setzero_si128();
+        for (; i < stop; i += 16)
+            acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), cont_max));
+        const __m128i s = _mm_sad_epu8(acc, _mm_setzero_si128());
+        count += static_cast<size_t>(_mm_cvtsi128_si32(s)) + static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(s, 8)));
+    }
+#endif
+    (void)p; (void)count;
+    return i;
+}
+
+} // namespace impl
+
+// Number of code points in p[0..n)
+constexpr size_t utf8_count(const char* p, size_t n) noexcept {
+    size_t i{}, count{};
+    if (!std::is_constant_evaluated()) i = impl::utf8_count_vectors(p, n, count);
+    for (; i < n; ++i) count += is_utf8_lead(p[i]);
+    return count;
+}
+
+// Offset of code point k (from 0) in p[0..n), or n if there are not that many. 64 bytes are skipped
+// per step by the popcount of their lead byte mask.
+constexpr size_t utf8_skip(const char* p, size_t n, size_t k) noexcept {
+    size_t i{};
+    if (!std::is_constant_evaluated())
+        for (; i + block <= n; i += block) {
+            const uint64_t m = impl::utf8_lead_mask64(p + i);
+            const auto c = static_cast<size_t>(std::popcount(m));
+            if (k < c) return i + impl::select_bit(m, k);
+            k -= c;
+        }
+    for (; i < n; ++i)
+        if (is_utf8_lead(p[i]) && k-- == 0) return i;
+    return n;
+}
+
+// Offset of the k-th code point counted from the end of p[0..n) (the last one is 1), or 0 if there
+// are not that many
+constexpr size_t utf8_rskip(const char* p, size_t n, size_t k) noexcept {
+    if (k == 0) return n;
+    size_t i = n;
+    if (!std::is_constant_evaluated())
+        for (; i >= block; i -= block) {
+            const uint64_t m = impl::utf8_lead_mask64(p + i - block);
+            const auto c = static_cast<size_t>(std::popcount(m));
+            if (k <= c) return i - block + impl::select_bit(m, c - k);
+            k -= c;
+        }
+    while (i > 0)
+        if (is_utf8_lead(p[--i]) && --k == 0) return i;
+    return 0;
+}
+
+namespace impl {
+
+// Length of the well-formed UTF-8 sequence at p[i], or 0 (RFC 3629: no overlong forms, no
+// surrogates, nothing above U+10FFFF)
+constexpr size_t utf8_seq_len(const char* p, size_t i, size_t n) noexcept {
+    const auto b = [p](size_t j) { return static_cast<unsigned char>(p[j]); };
+    const unsigned c = b(i);
+    if (c < 0x80) return 1;
+
+    size_t len;
+    unsigned lo = 0x80, hi = 0xBF;      // range of the second byte
+    if      (c >= 0xC2 && c <= 0xDF) len = 2;
+    else if (c >= 0xE0 && c <= 0xEF) { len = 3; if (c == 0xE0) lo = 0xA0; else if (c == 0xED) hi = 0x9F; }
+    else if (c >= 0xF0 && c <= 0xF4) { len = 4; if (c == 0xF0) lo = 0x90; else if (c == 0xF4) hi = 0x8F; }
+    else return 0;
+
+    if (n - i < len || b(i+1) < lo || b(i+1) > hi) return 0;
+    for (size_t j = 2; j < len; ++j)
+        if ((b(i+j) & 0xC0) != 0x80) return 0;
+    return len;
+}
+
+constexpr bool utf8_valid_scalar(const char* p, size_t n) noexcept {
+    for (size_t i = 0; i < n; ) {
+        const size_t len = utf8_seq_len(p, i, n);
+        if (len == 0) return false;
+        i += len;
+    }
+    return true;
+}
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+// The lookup algorithm of Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per
+// Byte" (simdjson/simdutf): three 16-entry nibble tables, indexed by the high and low nibble of the
+// previous byte and the high nibble of the current one, give a bitmask of the errors each pair of
+// bytes may be part of. Their AND is the errors present, except that a continuation byte expected
+// as the 3rd or 4th byte of a sequence must be flagged TWO_CONTS, which is checked separately.
+namespace utf8v {
+
+constexpr uint8_t TOO_SHORT      = 1 << 0;  // lead byte not followed by a continuation
+constexpr uint8_t TOO_LONG       = 1 << 1;  // continuation after ASCII
+constexpr uint8_t OVERLONG_3     = 1 << 2;
+constexpr uint8_t TOO_LARGE      = 1 << 3;
+constexpr uint8_t SURROGATE      = 1 << 4;
+constexpr uint8_t OVERLONG_2     = 1 << 5;
+constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+constexpr uint8_t OVERLONG_4     = 1 << 6;
+constexpr uint8_t TWO_CONTS      = 1 << 7;  // two continuations in a row
+constexpr uint8_t CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+alignas(16) constexpr uint8_t byte_1_high[16] {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,   // 0xxx ASCII
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                       // 10xx continuation
+    TOO_SHORT | OVERLONG_2,                                                           // 1100 two-byte lead
+    TOO_SHORT,                                                                        // 1101 two-byte lead
+    TOO_SHORT | OVERLONG_3 | SURROGATE,                                               // 1110 three-byte lead
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4                               // 1111 four-byte lead
+};
+alignas(16) constexpr uint8_t byte_1_low[16] {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+alignas(16) constexpr uint8_t byte_2_high[16] {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,   // 0xxx ASCII
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,             // 1000
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                               // 1001
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,                               // 1010
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,                               // 1011
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT                                                // 11xx lead
+};
+
+#if defined(__AVX2__)
+using vec = __m256i;
+inline vec  v_load(const char* p) noexcept    { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline vec  v_set1(uint8_t c) noexcept        { return _mm256_set1_epi8(static_cast<char>(c)); }
+inline vec  v_table(const uint8_t* t) noexcept { return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t))); }
+inline vec  v_lookup(vec t, vec i) noexcept   { return _mm256_shuffle_epi8(t, i); }
+inline vec  v_and(vec a, vec b) noexcept      { return _mm256_and_si256(a, b); }
+inline vec  v_or (vec a, vec b) noexcept      { return _mm256_or_si256(a, b); }
+inline vec  v_xor(vec a, vec b) noexcept      { return _mm256_xor_si256(a, b); }
+inline vec  v_subs(vec a, vec b) noexcept     { return _mm256_subs_epu8(a, b); }
+inline vec  v_hi4(vec v) noexcept             { return _mm256_and_si256(_mm256_srli_epi16(v, 4), v_set1(0x0F)); }
+inline bool v_ascii(vec v) noexcept           { return _mm256_movemask_epi8(v) == 0; }
+inline bool v_any(vec v) noexcept             { return !_mm256_testz_si256(v, v); }
+template <int N> vec v_prev(vec cur, vec prev) noexcept    // cur shifted in by N bytes from the end of prev
+    { return _mm256_alignr_epi8(cur, _mm256_permute2x128_si256(prev, cur, 0x21), 16 - N); }
+#else
+using vec = __m128i;
+inline vec  v_load(const char* p) noexcept    { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline vec  v_set1(uint8_t c) noexcept        { return _mm_set1_epi8(static_cast<char>(c)); }
+inline vec  v_table(const uint8_t* t) noexcept { return _mm_load_si128(reinterpret_cast<const __m128i*>(t)); }
+inline vec  v_lookup(vec t, vec i) noexcept   { return _mm_shuffle_epi8(t, i); }
+inline vec  v_and(vec a, vec b) noexcept      { return _mm_and_si128(a, b); }
+inline vec  v_or (vec a, vec b) noexcept      { return _mm_or_si128(a, b); }
+inline vec  v_xor(vec a, vec b) noexcept      { return _mm_xor_si128(a, b); }
+inline vec  v_subs(vec a, vec b) noexcept     { return _mm_subs_epu8(a, b); }
+inline vec  v_hi4(vec v) noexcept             { return _mm_and_si128(_mm_srli_epi16(v, 4), v_set1(0x0F)); }
+inline bool v_ascii(vec v) noexcept           { return _mm_movemask_epi8(v) == 0; }
+inline bool v_any(vec v) noexcept             { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xFFFF; }
+template <int N> vec v_prev(vec cur, vec prev) noexcept
+    { return _mm_alignr_epi8(cur, prev, 16 - N); }
+#endif
+
+class checker {
+private:
+    // A byte above max_ leaves its sequence open at the end of the vector: a lead byte of 4 among
+    // the last 3 bytes, of 3 among the last 2 or of 2 as the last one
+    static vec last3_max() noexcept {
+        alignas(32) uint8_t max[sizeof(vec)];
+        std::memset(max, 0xFF, sizeof(vec));
+        max[sizeof(vec) - 3] = 0xF0 - 1;
+        max[sizeof(vec) - 2] = 0xE0 - 1;
+        max[sizeof(vec) - 1] = 0xC0 - 1;
+        vec m;
+        std::memcpy(&m, max, sizeof(vec));
+        return m;
+    }
+
+    const vec t1_ {v_table(byte_1_high)}, t2_ {v_table(byte_1_low)}, t3_ {v_table(byte_2_high)};
+    const vec max_ {last3_max()};
+    vec error_ {v_set1(0)}, prev_ {v_set1(0)}, prev_incomplete_ {v_set1(0)};
+
+public:
+    void add(vec in) noexcept {
+        if (v_ascii(in)) {
+            error_ = v_or(error_, prev_incomplete_);
+        } else {
+            const vec prev1 = v_prev<1>(in, prev_);
+            const vec sc = v_and(v_and(v_lookup(t1_, v_hi4(prev1)), v_lookup(t2_, v_and(prev1, v_set1(0x0F)))),
+                                 v_lookup(t3_, v_hi4(in)));
+            const vec must23 = v_or(v_subs(v_prev<2>(in, prev_), v_set1(0xE0 - 0x80)),
+                                    v_subs(v_prev<3>(in, prev_), v_set1(0xF0 - 0x80)));
+            error_ = v_or(error_, v_xor(v_and(must23, v_set1(0x80)), sc));
+            prev_incomplete_ = v_subs(in, max_);
+        }
+        prev_ = in;
+    }
+
+    bool ok() const noexcept { return !v_any(v_or(error_, prev_incomplete_)); }
+    bool failed() const noexcept { return v_any(error_); }
+};
+
+} // namespace utf8v
+#endif
+
+} // namespace impl
+
+// p[0..n) is well-formed UTF-8
+inline bool utf8_valid(const char* p, size_t n) noexcept {
+#if defined(__AVX2__) || defined(__SSSE3__)
+    impl::utf8v::checker chk;
+    size_t i{};
+    for (; i + block <= n; i += block) {
+        for (size_t j = 0; j < block; j += sizeof(impl::utf8v::vec)) chk.add(impl::utf8v::v_load(p + i + j));
+        if (chk.failed()) return false;
+    }
+    if (i < n) {
+        // The tail is padded with ASCII NULs, which end any sequence left open as TOO_SHORT
+        alignas(32) char tail[block]{};
+        std::memcpy(tail, p + i, n - i);
+        for (size_t j = 0; j < block; j += sizeof(impl::utf8v::vec)) chk.add(impl::utf8v::v_load(tail + j));
+    }
+    return chk.ok();
+#else
+    size_t i{};
+    while (i < n) {
+#if defined(__SSE2__)
+        while (i + 16 <= n && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))) == 0) i += 16;
+        if (i == n) break;
+#endif
+        const size_t len = impl::utf8_seq_len(p, i, n);
+        if (len == 0) return false;
+        i += len;
+    }
+    return true;
+#endif
+}
+
+//------------------------------------------------------------------------
+inline size_t find_first_of(std::string_view sv, const charset& cs, size_t pos = 0) noexcept
+{
+    return cursor(sv, cs, pos).next();
+}
+
+// Call f(pos) for every member byte in sv
+template <typename F>
+void for_each_of(std::string_view sv, const charset& cs, F&& f)
+{
+    cursor cur(sv, cs);
+    for (size_t pos = cur.next(); pos != npos; pos = cur.next()) f(pos);
+}
+
+} // namespace strscan
@@ -0,0 +1,81 @@
+//  csv_stream fed in random chunks against csv_reader over the whole buffer, with records holding
+//  long multi-line quoted fields.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "strext.hpp"
+
+namespace {
+
+using TRows = std::vector<std::vector<std::string>>;
+
+TRows read_all(std::string_view text)
+{
+    TRows rows;
+    csv_reader rd(text);
+    TSvVec row;
+    while (rd.next(row)) rows.emplace_back(row.begin(), row.end());
+    return rows;
+}
+
+TRows read_chunked(std::string_view text, std::mt19937& rng, size_t max_chunk)
+{
+    TRows rows;
+    csv_stream rs([&](const TSvVec& row) { rows.emplace_back(row.begin(), row.end()); });
+    for (size_t off = 0; off < text.size(); ) {
+        const size_t n {std::min<size_t>(1 + rng() % max_chunk, text.size() - off)};
+        rs.feed(text.substr(off, n));
+        off += n;
+    }
+    rs.finish();
+    return rows;
+}
+
+} // namespace
+
+int main()
+{
+    // A short record, one whose middle field has 32k quoted lines (with escaped quotes and
+    // separators in them), then more short records
+    std::string text {"id,note,tail\n1,plain,x\n"};
+    text += "2,\"";
+    for (int i = 0; i < 32768; ++i) text += "line " + std::to_string(i) + (i % 7? ", more\n" : " \"\"quoted\"\"\r\n");
+    text += "\",end\n3,\"a\nb\",\"\"\n4,last";
+
+    const TRows want {read_all(text)};
+    if (want.size() != 5 || want[2].size() != 3 || want[2][2] != "end") { std::puts("csv_reader: unexpected records"); return 1; }
+
+    std::mt19937 rng(2026);
+    int failures {0};
+    const auto t0 {std::chrono::steady_clock::now()};
+    for (const size_t max_chunk : {1u, 7u, 64u, 1000u, 65536u, 1u << 20})
+        for (int round = 0; round < (max_chunk < 64? 1 : 5); ++round)
+            if (read_chunked(text, rng, max_chunk) != want) {
+                std::printf("csv_stream: records differ with chunks up to %zu bytes\n", max_chunk);
+                ++failures;
+            }
+    const double ms {std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()};
+
+    if (failures == 0) std::printf("csv_stream: ok (%.1f ms)\n", ms);
+    return failures == 0 ? 0 : 1;
+}
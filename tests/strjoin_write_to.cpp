@@ -0,0 +1,69 @@
+//  strjoin write_to(fd) with elements that do not outlive their step of the walk.
+//
+//  Copyright (C) 2026, Martin Young <martin_young@live.cn>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program. If not, see <https://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------
+
+#include <cstdio>
+#include <ranges>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "strjoin.hpp"
+
+namespace {
+
+int failures = 0;
+
+// What j.write_to() puts in a file, compared with std::string(j)
+template <typename J>
+void check(const char* name, const J& j)
+{
+    FILE* f {std::tmpfile()};
+    if (!f || !j.write_to(fileno(f))) { std::printf("%s: write_to failed\n", name); ++failures; return; }
+    std::string got(static_cast<size_t>(::lseek(fileno(f), 0, SEEK_END)), '\0');
+    ::pread(fileno(f), got.data(), got.size(), 0);
+    std::fclose(f);
+
+    const std::string want(j);
+    if (got != want) { std::printf("%s: wrote %zu bytes, expected %zu\n", name, got.size(), want.size()); ++failures; }
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<int> v(1000);
+    for (int i = 0; i < 1000; ++i) v[static_cast<size_t>(i)] = i;
+
+    // A projection returning std::string by value: more pieces than one writev and than the scratch buffer
+    check("by-value projection", strjoin(v, ",", [](int i) { return "val" + std::to_string(i); }));
+
+    // Elements larger than the scratch buffer
+    check("large by-value elements", strjoin(v, '\n', [](int i) { return std::string(5000 + static_cast<size_t>(i), static_cast<char>('a' + i % 26)); }));
+
+    // A view whose elements are prvalues
+    const auto strs = v | std::views::transform([](int i) { return std::to_string(i * 7); });
+    check("prvalue view", strjoin(strs, ", "));
+
+    // Lvalue strings keep the zero-copy path
+    std::vector<std::string> names;
+    for (int i : v) names.push_back("name" + std::to_string(i));
+    check("lvalue strings", strjoin(names, " | "));
+
+    if (failures == 0) std::puts("strjoin write_to: ok");
+    return failures == 0 ? 0 : 1;
+}
@@ -24,6 +24,13 @@
 #include <string_view>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <bit>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "strscan.hpp"
 
 class utf8_sv {
 private:
@@ -42,75 +49,107 @@ public:
     constexpr std::string_view base() const noexcept { return sv_; }
     constexpr bool empty() const noexcept { return sv_.empty(); }
 
-    constexpr size_t length() const noexcept {
-        size_t count = 0;
-        for (char c : sv_) if ((c & 0xC0) != 0x80) count++;
-        return count;
+    // Code points are counted, and found for left(), right() and substr(), by the vectorized
+    // kernels of strscan; in constant evaluation by a plain loop. A code point starts at each byte
+    // that is not a continuation byte, whether or not the text is valid: see validate().
+    constexpr size_t length() const noexcept { return strscan::utf8_count(sv_.data(), sv_.size()); }
+
+    // sv_ is well-formed UTF-8 (no stray or missing continuation bytes, overlong forms, surrogates
+    // or code points above U+10FFFF). Vectorized with SSSE3/AVX2 by the lookup algorithm of simdutf.
+    constexpr bool validate() const noexcept {
+        if (std::is_constant_evaluated()) return strscan::impl::utf8_valid_scalar(sv_.data(), sv_.size());
+        return strscan::utf8_valid(sv_.data(), sv_.size());
     }
 
     constexpr std::string_view left(size_t n = npos) const noexcept {
         if (n == 0) return {};
         if (n == npos) return sv_;
-
-        size_t b_idx = 0;
-        size_t chars_seen = 0;
-        const size_t sz = sv_.size();
-
-        while (b_idx < sz) {
-            if ((sv_[b_idx] & 0xC0) != 0x80) {
-                if (chars_seen == n) break;
-                chars_seen++;
-            }
-            b_idx++;
-        }
-        return sv_.substr(0, b_idx);
+        return sv_.substr(0, strscan::utf8_skip(sv_.data(), sv_.size(), n));
     }
 
     constexpr std::string_view right(size_t n = npos) const noexcept {
         if (n == 0) return {};
         if (n == npos || sv_.empty()) return sv_;
-
-        size_t b_idx = sv_.size();
-        size_t chars_seen = 0;
-
-        while (b_idx > 0) {
-            b_idx--;
-            if ((sv_[b_idx] & 0xC0) != 0x80) {
-                chars_seen++;
-                if (chars_seen == n) break;
-            }
-        }
-        return sv_.substr(b_idx);
+        return sv_.substr(strscan::utf8_rskip(sv_.data(), sv_.size(), n));
     }
 
     constexpr std::string_view substr(size_t pos = 0, size_t count = npos) const noexcept {
         if (pos == 0 && count == npos) return sv_;
 
-        size_t b_idx = 0;
-        size_t chars_seen = 0;
         const size_t sz = sv_.size();
-
-        while (b_idx < sz) {
-            if ((sv_[b_idx] & 0xC0) != 0x80) {
-                if (chars_seen == pos) break;
-                chars_seen++;
-            }
-            b_idx++;
-        }
-
+        const size_t b_idx = strscan::utf8_skip(sv_.data(), sz, pos);
         if (b_idx == sz) return {};
         if (count == npos) return sv_.substr(b_idx);
 
-        size_t end_idx = b_idx;
-        chars_seen = 0;
-        while (end_idx < sz) {
-            if ((sv_[end_idx] & 0xC0) != 0x80) {
-                if (chars_seen == count) break;
-                chars_seen++;
-            }
-            end_idx++;
+        return sv_.substr(b_idx, strscan::utf8_skip(sv_.data() + b_idx, sz - b_idx, count));
+    }
+};
+
+//------------------------------------------------------------------------
+// Byte offsets of every 64th code point of a text, for paging through it by code points without
+// rescanning from the start each time, eg.
+//     const utf8_index idx(doc);
+//     for (size_t pos = 0; pos < idx.length(); pos += 80) show(idx.substr(pos, 80));
+// It is built by one pass of the lead byte masks of strscan, 64 bytes per step, and takes 4 bytes
+// per 64 code points. A lookup starts from the nearest sample below and skips fewer than 64 code
+// points, at most 256 bytes. Like utf8_sv it keeps a view: the text must outlive the index.
+// Throws std::length_error for texts of 4GB or more.
+class utf8_index {
+private:
+    std::string_view sv_;
+    std::vector<uint32_t> samples_;     // samples_[j]: offset of code point j*stride
+    size_t length_{};
+
+public:
+    static constexpr size_t npos   = std::string_view::npos;
+    static constexpr size_t stride = 64;
+
+    utf8_index() = default;
+    explicit utf8_index(utf8_sv str): sv_(str.base()) {
+        if (sv_.size() >= UINT32_MAX) throw std::length_error("utf8_index: text of 4GB or more");
+        const char* p = sv_.data();
+        const size_t n = sv_.size();
+        samples_.reserve(n / stride + 1);
+
+        // next: the code point still to be sampled, relative to the count before block i
+        size_t i{}, count{}, next{};
+        for (; i + strscan::block <= n; i += strscan::block) {
+            const uint64_t m = strscan::impl::utf8_lead_mask64(p + i);
+            const auto c = static_cast<size_t>(std::popcount(m));
+            for (; next < c; next += stride) samples_.push_back(static_cast<uint32_t>(i + strscan::impl::select_bit(m, next)));
+            next -= c;
+            count += c;
         }
+        for (; i < n; ++i)
+            if (strscan::is_utf8_lead(p[i])) {
+                if (next == 0) { samples_.push_back(static_cast<uint32_t>(i)); next = stride; }
+                --next;
+                ++count;
+            }
+        length_ = count;
+    }
 
-        return sv_.substr(b_idx, end_idx - b_idx);
+    std::string_view base() const noexcept { return sv_; }
+    size_t length() const noexcept { return length_; }
+    // Heap bytes of the samples
+    size_t bytes() const noexcept { return samples_.capacity() * sizeof(uint32_t); }
+
+    // Byte offset of code point k (from 0), or the byte size if there are not that many
+    size_t offset(size_t k) const noexcept {
+        if (k >= length_) return sv_.size();
+        const size_t b = samples_[k / stride];
+        return b + strscan::utf8_skip(sv_.data() + b, sv_.size() - b, k % stride);
+    }
+
+    // As utf8_sv's, without the scan from the start
+    std::string_view left(size_t n = npos) const noexcept { return n == 0? std::string_view{} : sv_.substr(0, offset(n)); }
+    std::string_view right(size_t n = npos) const noexcept {
+        return n > length_? sv_ : sv_.substr(offset(length_ - n));
+    }
+    std::string_view substr(size_t pos = 0, size_t count = npos) const noexcept {
+        if (pos == 0 && count == npos) return sv_;
+        if (pos >= length_) return {};
+        const size_t b = offset(pos);
+        return sv_.substr(b, count >= length_ - pos? npos : offset(pos + count) - b);
     }
 };